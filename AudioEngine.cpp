@@ -1,10 +1,12 @@
 #include "AudioEngine.hpp"
+#include "DspPipeline.hpp"
 #include "LogBins.hpp"
+#include "ShmFrameRing.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <cstdlib>
 #include <stdexcept>
 
 #if __has_include(<portaudio.h>)
@@ -17,23 +19,16 @@ struct PaStreamCallbackTimeInfo;
 using PaStreamCallbackFlags = unsigned long;
 #endif
 
-#if __has_include(<kissfft/kiss_fftr.h>)
-#include <kissfft/kiss_fftr.h>
-#define AUDIOENGINE_HAS_KISSFFT 1
-#else
-#define AUDIOENGINE_HAS_KISSFFT 0
-using kiss_fftr_cfg = void*;
-struct kiss_fft_cpx { float r; float i; };
-#endif
+AudioEngine::AudioEngine(int sampleRate_, int fftSize, int logBins, const std::string& flacOutputPath)
+    : AudioEngine(sampleRate_, fftSize, logBins, flacOutputPath, true) {}
 
-namespace {
-constexpr float kPi = 3.14159265358979323846f;
-} // namespace
+AudioEngine::AudioEngine(int sampleRate_, int fftSize, int logBins, const std::string& flacOutputPath,
+                         CustomAnalysis)
+    : AudioEngine(sampleRate_, fftSize, logBins, flacOutputPath, false) {}
 
-AudioEngine::AudioEngine(int sampleRate_, int fftSize_, int logBins_, const std::string& flacOutputPath)
+AudioEngine::AudioEngine(int sampleRate_, int fftSize, int logBins, const std::string& flacOutputPath,
+                         bool prepareChain)
     : sampleRate(sampleRate_),
-      fftSize(fftSize_),
-      logBins(logBins_),
       flacPath(flacOutputPath),
       flacEnabled(!flacOutputPath.empty()) {
     if (sampleRate <= 0) sampleRate = 48000;
@@ -42,6 +37,8 @@ AudioEngine::AudioEngine(int sampleRate_, int fftSize_, int logBins_, const std:
 
     latestLog.resize(static_cast<std::size_t>(logBins), 0.0f);
     captureBuffer.resize(static_cast<std::size_t>(fftSize), 0.0f);
+    hopLatencyUs.resize(kHopLatencyHistory, 0.0f);
+    plan = buildPlan(fftSize, logBins, hopMs.load(), captureBuffer.size(), prepareChain);
 }
 
 AudioEngine::~AudioEngine() {
@@ -50,29 +47,65 @@ AudioEngine::~AudioEngine() {
 
 void AudioEngine::start() {
     if (running.load()) return;
-    running = true;
-
-#if AUDIOENGINE_HAS_PORTAUDIO
-    Pa_Initialize();
-#else
-    // Still start a thread so the app doesn't hang, but it will error immediately.
-#endif
-
-    if (flacEnabled) initFlac();
+    beginCapture();
     audioThread = std::thread(&AudioEngine::audioThreadFunc, this);
 }
 
+void AudioEngine::startHosted() {
+    if (running.load()) return;
+    beginCapture();
+}
+
 void AudioEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(reconfigureMutex);
+        if (planBuilder.joinable()) planBuilder.join();
+    }
+
     if (!running.load()) return;
     running = false;
 
     if (audioThread.joinable()) audioThread.join();
 
-    if (flacEnabled) closeFlac();
+    endCapture();
+}
 
-#if AUDIOENGINE_HAS_PORTAUDIO
-    Pa_Terminate();
+void AudioEngine::pushSamples(const float* samples, std::size_t count) {
+    if (!captureThreadTuned.exchange(true)) {
+        std::string error;
+        if (!thread_tuning::applyToCurrentThread(realtime.capture, &error))
+            addRealtimeWarning("capture thread: " + error);
+        if (realtime.lockMemory) thread_tuning::prefaultStack();
+    }
+
+    // Write to ring buffer (mono).
+    {
+        std::lock_guard<std::mutex> lock(captureMutex);
+        std::size_t writeIdx = captureWriteIdx.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < count; i++) {
+            captureBuffer[writeIdx] = samples[i];
+            writeIdx = (writeIdx + 1) % captureBuffer.size();
+        }
+        captureWriteIdx.store(writeIdx, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(zoomMutex);
+        if (zoom) zoom->push(samples, count);
+    }
+
+    if (flacEnabled && flacEncoder) {
+#if AUDIOENGINE_HAS_FLAC
+        static thread_local std::vector<FLAC__int32> pcm;
+        pcm.resize(count);
+        for (std::size_t i = 0; i < count; i++)
+            pcm[i] = static_cast<FLAC__int32>(samples[i] * 32767.0f);
+
+        FLAC__stream_encoder_process_interleaved(
+            flacEncoder, pcm.data(), static_cast<unsigned>(count)
+        );
 #endif
+    }
 }
 
 std::vector<float> AudioEngine::getLogBins() {
@@ -80,34 +113,179 @@ std::vector<float> AudioEngine::getLogBins() {
     return latestLog;
 }
 
-std::vector<std::pair<float, float>> AudioEngine::computeLogBinFreqs() const {
-    std::vector<std::pair<float, float>> out;
-    out.reserve(static_cast<std::size_t>(logBins));
+bool AudioEngine::setZoomBand(float lowHz, float highHz, int fftSize) {
+    const dsp::ZoomBand band{lowHz, highHz, fftSize};
+    if (!dsp::ZoomAnalyzer::valid(sampleRate, band)) return false;
 
-    const float fMin = 20.0f;
-    const float fMax = static_cast<float>(sampleRate) * 0.5f;
+    // Filter design and allocation happen outside the capture path.
+    std::shared_ptr<dsp::ZoomAnalyzer> next = std::make_shared<dsp::ZoomAnalyzer>(sampleRate, band);
+    {
+        std::lock_guard<std::mutex> lock(zoomMutex);
+        zoom.swap(next);
+    }
+    return true;
+}
 
-    for (int i = 0; i < logBins; i++) {
-        const float a = static_cast<float>(i) / static_cast<float>(logBins);
-        const float b = static_cast<float>(i + 1) / static_cast<float>(logBins);
+void AudioEngine::clearZoomBand() {
+    std::shared_ptr<dsp::ZoomAnalyzer> old;
+    {
+        std::lock_guard<std::mutex> lock(zoomMutex);
+        zoom.swap(old);
+    }
+}
 
-        const float fLow  = fMin * std::pow(fMax / fMin, a);
-        const float fHigh = fMin * std::pow(fMax / fMin, b);
+AudioEngine::ZoomSpectrum AudioEngine::getZoomSpectrum() {
+    std::lock_guard<std::mutex> lock(logMutex);
+    return latestZoom;
+}
 
-        out.emplace_back(fLow, fHigh);
+void AudioEngine::processZoom() {
+    std::shared_ptr<dsp::ZoomAnalyzer> current;
+    {
+        std::lock_guard<std::mutex> zoomLock(zoomMutex);
+        current = zoom;
+        if (current) current->capture();
     }
-    return out;
+    if (!current) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        latestZoom.bins.clear();
+        return;
+    }
+
+    // Only this (analysis) thread calls transform().
+    const auto& bins = current->transform();
+    std::lock_guard<std::mutex> lock(logMutex);
+    latestZoom.lowHz = current->band().lowHz;
+    latestZoom.highHz = current->band().highHz;
+    latestZoom.startHz = current->startHz();
+    latestZoom.binHz = current->binHz();
+    latestZoom.bins.assign(bins.begin(), bins.end());
 }
 
 std::vector<float> AudioEngine::getLogBinCenters() const {
-    auto ranges = computeLogBinFreqs();
-    std::vector<float> centers;
-    centers.reserve(ranges.size());
+    std::lock_guard<std::mutex> lock(planMutex);
+    return plan->centers;
+}
+
+AudioEngine::Info AudioEngine::getInfo() const {
+    std::lock_guard<std::mutex> lock(planMutex);
+    return Info{
+        plan->config.sampleRate,
+        plan->config.fftSize,
+        plan->config.logBins,
+        plan->hopMs,
+        configVersion,
+        plan->centers
+    };
+}
+
+std::uint64_t AudioEngine::getConfigVersion() const {
+    std::lock_guard<std::mutex> lock(planMutex);
+    return configVersion;
+}
+
+void AudioEngine::setReconfigureCallback(ReconfigureCallback cb) {
+    reconfigureCallback = std::move(cb);
+}
+
+std::unique_ptr<AudioEngine::AnalysisPlan> AudioEngine::buildPlan(
+    int fftSize, int logBins, int hop, std::size_t ringSize, bool prepareChain) const {
+    auto p = std::make_unique<AnalysisPlan>();
+    p->config = dsp::Config{sampleRate, fftSize, logBins};
+    p->hopMs = hop;
+    if (prepareChain) p->chain.prepare(p->config);
 
-    for (const auto& r : ranges)
-        centers.push_back(std::sqrt(r.first * r.second));
+    p->centers = LogBins::centers(sampleRate, logBins);
 
-    return centers;
+    // The capture ring only grows, so shrinking the FFT never drops history.
+    if (static_cast<std::size_t>(fftSize) > ringSize)
+        p->ring.assign(static_cast<std::size_t>(fftSize), 0.0f);
+    return p;
+}
+
+bool AudioEngine::reconfigure(int fftSize, int logBins, int hop) {
+    if (fftSize < kMinFftSize || fftSize > kMaxFftSize || (fftSize & (fftSize - 1)) != 0) return false;
+    if (logBins <= 0 || logBins > kMaxLogBins || hop <= 0 || hop > kMaxHopMs) return false;
+
+    std::lock_guard<std::mutex> lock(reconfigureMutex);
+    if (planBuilder.joinable()) planBuilder.join();
+
+    std::size_t ringSize = 0;
+    {
+        std::lock_guard<std::mutex> captureLock(captureMutex);
+        ringSize = captureBuffer.size();
+    }
+
+    planBuilder = std::thread([this, fftSize, logBins, hop, ringSize, name = shmName, slots = shmSlots]() {
+        std::shared_ptr<AnalysisPlan> next = buildPlan(fftSize, logBins, hop, ringSize);
+
+        // Drop a plan that was never adopted and earlier rings before the new
+        // ring takes over the shared-memory name.
+        std::shared_ptr<AnalysisPlan> stale;
+        std::vector<std::unique_ptr<ShmFrameRing>> retired;
+        {
+            std::lock_guard<std::mutex> planLock(planMutex);
+            stale = std::move(pendingPlan);
+            retired.swap(retiredShmRings);
+        }
+        stale.reset();
+        retired.clear();
+
+        if (!name.empty()) {
+            // The record size changes with the bin count: a new ring, created
+            // here so the analysis thread only swaps the pointer.
+            next->shm = std::make_unique<ShmFrameRing>();
+            if (!next->shm->create(name, slots, sampleRate, fftSize, next->centers)) next->shm.reset();
+        }
+
+        std::lock_guard<std::mutex> planLock(planMutex);
+        pendingPlan = std::move(next);
+    });
+    return true;
+}
+
+void AudioEngine::adoptPendingPlan() {
+    std::shared_ptr<AnalysisPlan> next;
+    {
+        std::lock_guard<std::mutex> lock(planMutex);
+        next = std::move(pendingPlan);
+    }
+    if (!next) return;
+
+    if (next->ring.size() > captureBuffer.size()) {
+        // Carry the captured history over in chronological order (newest at
+        // the end), so the first hop on the new plan sees no gap.
+        std::lock_guard<std::mutex> lock(captureMutex);
+        const std::size_t oldSize = captureBuffer.size();
+        const std::size_t offset = next->ring.size() - oldSize;
+        const std::size_t w = captureWriteIdx.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < oldSize; i++)
+            next->ring[offset + i] = captureBuffer[(w + i) % oldSize];
+        captureBuffer.swap(next->ring);
+        captureWriteIdx.store(0, std::memory_order_relaxed);
+    }
+    next->ring.clear();
+    next->ring.shrink_to_fit();
+
+    std::unique_ptr<ShmFrameRing> replacedShm;
+    if (shmRing || next->shm) {
+        // Readers of the old ring see it retired and reopen the new one.
+        if (shmRing) shmRing->retire();
+        replacedShm = std::move(shmRing);
+        shmRing = std::move(next->shm);
+    }
+
+    hopMs = next->hopMs;
+    {
+        std::lock_guard<std::mutex> lock(planMutex);
+        plan = std::move(next);
+        ++configVersion;
+        if (replacedShm) retiredShmRings.push_back(std::move(replacedShm));
+    }
+
+    const Info info = getInfo();
+
+    if (reconfigureCallback) reconfigureCallback(info);
 }
 
 #if AUDIOENGINE_HAS_PORTAUDIO
@@ -123,49 +301,61 @@ static int paCallback(
     const float* in = static_cast<const float*>(input);
     if (!in) return paContinue;
 
-    // Write to ring buffer (mono).
-    {
-        std::lock_guard<std::mutex> lock(eng->captureMutex);
-        std::size_t writeIdx = eng->captureWriteIdx.load(std::memory_order_relaxed);
-        for (std::size_t i = 0; i < static_cast<std::size_t>(frameCount); i++) {
-            eng->captureBuffer[writeIdx] = in[i];
-            writeIdx = (writeIdx + 1) % static_cast<std::size_t>(eng->fftSize);
-        }
-        eng->captureWriteIdx.store(writeIdx, std::memory_order_relaxed);
-    }
+    eng->pushSamples(in, static_cast<std::size_t>(frameCount));
+    return paContinue;
+}
+#endif
 
-    if (eng->flacEnabled && eng->flacEncoder) {
-#if AUDIOENGINE_HAS_FLAC
-        static thread_local std::vector<FLAC__int32> pcm;
-        pcm.resize(static_cast<std::size_t>(frameCount));
-        for (std::size_t i = 0; i < static_cast<std::size_t>(frameCount); i++)
-            pcm[i] = static_cast<FLAC__int32>(in[i] * 32767.0f);
+void AudioEngine::setRealtimeOptions(const RealtimeOptions& options) {
+    realtime = options;
+}
 
-        FLAC__stream_encoder_process_interleaved(
-            eng->flacEncoder, pcm.data(), static_cast<unsigned>(frameCount)
-        );
-#endif
-    }
+std::vector<std::string> AudioEngine::getRealtimeWarnings() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return realtimeWarnings;
+}
 
-    return paContinue;
+void AudioEngine::addRealtimeWarning(const std::string& what) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    realtimeWarnings.push_back(what);
 }
-#endif
 
-void AudioEngine::audioThreadFunc() {
-#if !(AUDIOENGINE_HAS_PORTAUDIO && AUDIOENGINE_HAS_KISSFFT)
-    // Deps not present in this build environment; keep running but produce zeros.
-    // (Throwing from a std::thread would call std::terminate.)
-    std::vector<float> zeros(static_cast<std::size_t>(logBins), 0.0f);
-    while (running.load()) {
-        {
-            std::lock_guard<std::mutex> lock(logMutex);
-            latestLog = zeros;
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+std::vector<float> AudioEngine::getHopLatenciesUs() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    const std::size_t n = std::min(hopLatencyCount, kHopLatencyHistory);
+    std::vector<float> out;
+    out.reserve(n);
+    for (std::size_t i = hopLatencyCount - n; i < hopLatencyCount; i++)
+        out.push_back(hopLatencyUs[i % kHopLatencyHistory]);
+    return out;
+}
+
+void AudioEngine::recordHopLatency(float us) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    hopLatencyUs[hopLatencyCount % kHopLatencyHistory] = us;
+    hopLatencyCount++;
+}
+
+void AudioEngine::beginCapture() {
+    running = true;
+    captureThreadTuned = realtime.capture.isDefault() && !realtime.lockMemory;
+
+    if (realtime.lockMemory) {
+        std::string error;
+        if (!thread_tuning::lockProcessMemory(&error)) addRealtimeWarning(error);
+        thread_tuning::prefault(captureBuffer.data(), captureBuffer.size() * sizeof(float));
+        thread_tuning::prefault(latestLog.data(), latestLog.size() * sizeof(float));
+        thread_tuning::prefault(hopLatencyUs.data(), hopLatencyUs.size() * sizeof(float));
     }
-#else
-    PaStream* stream = nullptr;
 
+#if AUDIOENGINE_HAS_PORTAUDIO
+    Pa_Initialize();
+#endif
+
+    if (flacEnabled) initFlac();
+
+#if AUDIOENGINE_HAS_PORTAUDIO
+    PaStream* stream = nullptr;
     Pa_OpenDefaultStream(
         &stream,
         1, 0,
@@ -176,55 +366,87 @@ void AudioEngine::audioThreadFunc() {
         this
     );
     Pa_StartStream(stream);
+    captureStream = stream;
+#else
+    // PortAudio not present in this build environment: only pushSamples()
+    // fills the capture ring; otherwise the analysis publishes silence.
+#endif
+}
 
-    kiss_fftr_cfg cfg = kiss_fftr_alloc(fftSize, 0, nullptr, nullptr);
+void AudioEngine::endCapture() {
+#if AUDIOENGINE_HAS_PORTAUDIO
+    if (captureStream) {
+        Pa_StopStream(static_cast<PaStream*>(captureStream));
+        Pa_CloseStream(static_cast<PaStream*>(captureStream));
+        captureStream = nullptr;
+    }
+#endif
 
-    std::vector<float> window(static_cast<std::size_t>(fftSize));
-    for (int i = 0; i < fftSize; i++)
-        window[static_cast<std::size_t>(i)] =
-            0.5f - 0.5f * std::cos(2.0f * kPi * static_cast<float>(i) / static_cast<float>(fftSize - 1));
+    if (flacEnabled) closeFlac();
 
-    std::vector<float> block(static_cast<std::size_t>(fftSize));
-    std::vector<kiss_fft_cpx> out(static_cast<std::size_t>(fftSize / 2 + 1));
-    std::vector<float> mag(static_cast<std::size_t>(fftSize / 2));
+#if AUDIOENGINE_HAS_PORTAUDIO
+    Pa_Terminate();
+#endif
+}
 
-    while (running.load()) {
-        // Snapshot last fftSize samples from ring buffer into chronological order.
-        {
-            std::lock_guard<std::mutex> lock(captureMutex);
-            const std::size_t w = captureWriteIdx.load(std::memory_order_relaxed);
-            for (int i = 0; i < fftSize; ++i) {
-                const std::size_t idx =
-                    (w + static_cast<std::size_t>(i)) % static_cast<std::size_t>(fftSize);
-                block[static_cast<std::size_t>(i)] = captureBuffer[idx];
-            }
-        }
+void AudioEngine::processHop() {
+    adoptPendingPlan();
+    dsp::LogBinChain& chain = plan->chain;
 
-        for (int i = 0; i < fftSize; i++)
-            block[static_cast<std::size_t>(i)] *= window[static_cast<std::size_t>(i)];
+    // Snapshot + window and magnitude + log-bin averaging each run as one
+    // fused pass over preallocated buffers.
+    {
+        std::lock_guard<std::mutex> lock(captureMutex);
+        chain.runHead(captureView());
+    }
 
-        kiss_fftr(cfg, block.data(), out.data());
+    const auto& log = chain.runTail();
+    publishLogBins(log.data(), log.size());
+}
 
-        for (int i = 0; i < fftSize / 2; i++) {
-            const float r = out[static_cast<std::size_t>(i)].r;
-            const float im = out[static_cast<std::size_t>(i)].i;
-            mag[static_cast<std::size_t>(i)] = std::sqrt(r * r + im * im);
-        }
+void AudioEngine::publishLogBins(const float* bins, std::size_t count) {
+    if (shmRing) {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        shmRing->publish(bins, count, std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
 
-        auto log = LogBins::compute(mag, sampleRate, fftSize, logBins);
+    std::lock_guard<std::mutex> lock(logMutex);
+    latestLog.assign(bins, bins + count);
+}
 
-        {
-            std::lock_guard<std::mutex> lock(logMutex);
-            latestLog = std::move(log);
-        }
+bool AudioEngine::enableSharedMemory(const std::string& name, std::uint32_t slots, std::string* error) {
+    const Info info = getInfo();
+    auto ring = std::make_unique<ShmFrameRing>();
+    if (!ring->create(name, slots, info.sampleRate, info.fftSize, info.centers, error)) return false;
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    shmRing = std::move(ring);
+    shmName = name;
+    shmSlots = slots;
+    return true;
+}
+
+void AudioEngine::audioThreadFunc() {
+    {
+        std::string error;
+        if (!thread_tuning::applyToCurrentThread(realtime.analysis, &error))
+            addRealtimeWarning("analysis thread: " + error);
+        if (realtime.lockMemory) thread_tuning::prefaultStack();
     }
 
-    std::free(cfg);
-    Pa_StopStream(stream);
-    Pa_CloseStream(stream);
-#endif
+    // Hops run on absolute ticks so a slow hop does not shift the cadence.
+    using Clock = std::chrono::steady_clock;
+    auto tick = Clock::now();
+    while (running.load()) {
+        processHop();
+        processZoom();
+
+        const auto done = Clock::now();
+        recordHopLatency(std::chrono::duration<float, std::micro>(done - tick).count());
+
+        tick += std::chrono::milliseconds(hopMs.load());
+        if (tick < done) tick = done; // fell behind: resynchronise
+        std::this_thread::sleep_until(tick);
+    }
 }
 
 void AudioEngine::initFlac() {
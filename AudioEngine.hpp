@@ -1,12 +1,19 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include "DspPipeline.hpp"
+#include "ThreadTuning.hpp"
+#include "ZoomFft.hpp"
+
 #if __has_include(<FLAC/stream_encoder.h>)
 #include <FLAC/stream_encoder.h>
 #define AUDIOENGINE_HAS_FLAC 1
@@ -16,6 +23,8 @@
 struct FLAC__StreamEncoder;
 #endif
 
+class ShmFrameRing;
+
 class AudioEngine {
 public:
     AudioEngine(
@@ -25,35 +34,197 @@ public:
         const std::string& flacOutputPath = ""
     );
 
-    ~AudioEngine();
+    virtual ~AudioEngine();
 
     void start();
     void stop();
 
+    // Hosted mode (EngineHost): capture and FLAC recording run, but no
+    // analysis thread is started; the host calls runHop() on its own schedule.
+    // Hops of one engine must not overlap.
+    void startHosted();
+    void runHop() {
+        processHop();
+        processZoom();
+    }
+
+    // Feed mono samples into the capture ring and FLAC recording. Called from
+    // the PortAudio callback; also usable for external or synthetic sources.
+    void pushSamples(const float* samples, std::size_t count);
+
     std::vector<float> getLogBins();             // 64/128 bins, call every 200 ms
     std::vector<float> getLogBinCenters() const; // center frequency per bin
 
+    // Active analysis configuration; version increments on every reconfigure.
+    struct Info {
+        int sampleRate;
+        int fftSize;
+        int logBins;
+        int hopMs;
+        std::uint64_t version;
+        std::vector<float> centers;
+    };
+    Info getInfo() const;
+    std::uint64_t getConfigVersion() const;
+
+    // Zoom FFT of one narrow band next to the log bins (dsp::ZoomAnalyzer),
+    // e.g. 50-70 Hz at sub-hertz resolution without raising fftSize. Can be
+    // set, changed or cleared while running; a new band starts with an empty
+    // window that fills as samples arrive. Returns false for an invalid band.
+    bool setZoomBand(float lowHz, float highHz, int fftSize = 256);
+    void clearZoomBand();
+
+    struct ZoomSpectrum {
+        float lowHz = 0.0f;
+        float highHz = 0.0f;
+        float startHz = 0.0f;    // center of bins[0]
+        float binHz = 0.0f;
+        std::vector<float> bins; // empty when no band is set
+    };
+    ZoomSpectrum getZoomSpectrum();
+
+    // Change FFT size, bin count and hop interval while running. The new plan
+    // (window, FFT config, bin ranges, larger capture ring if needed) is built
+    // on a helper thread and swapped in between two hops; capture and FLAC
+    // recording are not interrupted. Returns false if the request is invalid
+    // or the engine does not support it (FixedAudioEngine). fftSize must be a
+    // power of two in [kMinFftSize, kMaxFftSize], logBins in [1, kMaxLogBins]
+    // and hopMs in [1, kMaxHopMs].
+    // In hosted mode the host's hop interval applies instead of hopMs.
+    static constexpr int kMinFftSize = 64;
+    static constexpr int kMaxFftSize = 65536;
+    static constexpr int kMaxLogBins = 1024;
+    static constexpr int kMaxHopMs = 1000;
+    virtual bool reconfigure(int fftSize, int logBins, int hopMs = 50);
+
+    // Called on the analysis thread right after a new configuration is active.
+    using ReconfigureCallback = std::function<void(const Info&)>;
+    void setReconfigureCallback(ReconfigureCallback cb);
+
+    // Scheduling / pinning / memory locking, applied by start() and
+    // startHosted(); set before starting. Failures (e.g. missing privileges)
+    // do not stop the engine and are reported by getRealtimeWarnings().
+    struct RealtimeOptions {
+        ThreadPolicy analysis;   // the engine's analysis thread
+        ThreadPolicy capture;    // first thread calling pushSamples() after start,
+                                 // i.e. the PortAudio callback, which also encodes FLAC
+        bool lockMemory = false; // mlockall() and prefault buffers and stacks
+                                 // (process-wide, see below)
+    };
+    // lockMemory locks every current and future page of the whole process,
+    // not just this engine, and stays in effect after stop(): other engines
+    // or libraries may rely on it. Call thread_tuning::unlockProcessMemory()
+    // to undo it.
+    void setRealtimeOptions(const RealtimeOptions& options);
+    std::vector<std::string> getRealtimeWarnings() const;
+
+    // Also publish every frame into a named POSIX shared-memory ring (e.g.
+    // "/audioengine" -> /dev/shm/audioengine) for co-located consumers; see
+    // ShmFrameReader. Call before start(). After a reconfiguration the ring is
+    // recreated under the same name and the old one is marked retired.
+    bool enableSharedMemory(const std::string& name, std::uint32_t slots = 256, std::string* error = nullptr);
+
+    // Completion latency of the most recent hops in microseconds (scheduled
+    // tick to published result), oldest first. Own analysis thread only.
+    std::vector<float> getHopLatenciesUs() const;
+
+protected:
+    // For engines that override processHop() with their own analysis
+    // (FixedAudioEngine): the base keeps the configuration and bin centers
+    // but builds no window or FFT plan, and its processHop() must not run.
+    struct CustomAnalysis {};
+    AudioEngine(int sampleRate, int fftSize, int logBins, const std::string& flacOutputPath, CustomAnalysis);
+
+    // One analysis hop: snapshot the capture ring, analyze, publish.
+    // Specialised engines (FixedAudioEngine) override this; derived classes
+    // must call stop() in their destructor so no hop runs during teardown.
+    virtual void processHop();
+
+    void publishLogBins(const float* bins, std::size_t count);
+
+    dsp::RingView captureView() const {
+        return dsp::RingView{
+            captureBuffer.data(),
+            captureBuffer.size(),
+            captureWriteIdx.load(std::memory_order_relaxed)
+        };
+    }
+
 private:
+    // Everything one configuration needs; built off the analysis thread.
+    struct AnalysisPlan {
+        dsp::Config config;
+        int hopMs;
+        dsp::LogBinChain chain;
+        std::vector<float> centers;
+        std::vector<float> ring; // replacement capture ring, empty if not grown
+        std::unique_ptr<ShmFrameRing> shm; // replacement shared-memory ring, if enabled
+    };
+
     void audioThreadFunc();
+    void beginCapture();
+    void endCapture();
     void initFlac();
     void closeFlac();
+    void adoptPendingPlan();
+    void processZoom();
 
-    std::vector<std::pair<float,float>> computeLogBinFreqs() const;
+    AudioEngine(int sampleRate, int fftSize, int logBins, const std::string& flacOutputPath, bool prepareChain);
 
-private:
+    std::unique_ptr<AnalysisPlan> buildPlan(int fftSize, int logBins, int hopMs, std::size_t ringSize,
+                                            bool prepareChain = true) const;
+
+protected:
     int sampleRate;
-    int fftSize;
-    int logBins;
 
+    std::vector<float> captureBuffer;
+    std::atomic<std::size_t> captureWriteIdx{0};
+    std::mutex captureMutex;
+
+private:
     std::thread audioThread;
     std::atomic<bool> running{false};
+    void* captureStream{nullptr}; // PaStream*
 
     std::vector<float> latestLog;
+    ZoomSpectrum latestZoom;
     std::mutex logMutex;
 
-    std::vector<float> captureBuffer;
-    std::atomic<std::size_t> captureWriteIdx{0};
-    std::mutex captureMutex;
+    // Fed by pushSamples(), read once per hop. zoomMutex covers push() and
+    // the window copy only; the hop keeps its own reference for the FFT so
+    // the capture callback never waits on it.
+    std::shared_ptr<dsp::ZoomAnalyzer> zoom;
+    std::mutex zoomMutex;
+
+    // plan is only swapped by the analysis thread; planMutex guards the
+    // pointer for readers on other threads.
+    std::shared_ptr<AnalysisPlan> plan;
+    std::shared_ptr<AnalysisPlan> pendingPlan;
+    std::uint64_t configVersion{0};
+    mutable std::mutex planMutex;
+    std::atomic<int> hopMs{50};
+
+    std::thread planBuilder;
+    std::mutex reconfigureMutex;
+    ReconfigureCallback reconfigureCallback;
+
+    static constexpr std::size_t kHopLatencyHistory = 4096;
+    void recordHopLatency(float us);
+    void addRealtimeWarning(const std::string& what);
+
+    std::unique_ptr<ShmFrameRing> shmRing; // touched only by the analysis thread once started
+    std::string shmName;
+    std::uint32_t shmSlots{0};
+    // Rings replaced by a reconfiguration, unmapped by the next plan builder
+    // (or the destructor) instead of on the analysis thread. Under planMutex.
+    std::vector<std::unique_ptr<ShmFrameRing>> retiredShmRings;
+
+    RealtimeOptions realtime;
+    std::atomic<bool> captureThreadTuned{false};
+    std::vector<std::string> realtimeWarnings;
+    std::vector<float> hopLatencyUs;   // ring of kHopLatencyHistory entries
+    std::size_t hopLatencyCount{0};
+    mutable std::mutex statsMutex;
 
     std::string flacPath;
     bool flacEnabled{false};
@@ -0,0 +1,366 @@
+#include "BatchSpectrogram.hpp"
+
+#include "DspPipeline.hpp"
+#include "JsonFormat.hpp"
+#include "LogBins.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#if __has_include(<FLAC/stream_decoder.h>)
+#include <FLAC/stream_decoder.h>
+#define AUDIOENGINE_HAS_FLAC_DECODER 1
+#else
+#define AUDIOENGINE_HAS_FLAC_DECODER 0
+#endif
+
+namespace {
+
+void setError(std::string* error, const std::string& what) {
+  if (error) *error = what;
+}
+
+// Raw float32 frames plus the metadata message next to them.
+class FrameFileWriter final {
+public:
+  ~FrameFileWriter() { close(); }
+
+  bool open(const std::string& path, std::string* error) {
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+      setError(error, "cannot open " + path);
+      return false;
+    }
+    m_path = path;
+    return true;
+  }
+
+  void write(const float* frames, std::size_t values) {
+    if (m_file && std::fwrite(frames, sizeof(float), values, m_file) != values) m_failed = true;
+  }
+
+  bool finish(int sampleRate, const BatchSpectrogram::Options& options, std::string* error) {
+    if (!m_file) return false;
+    const bool closed = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    if (m_failed || !closed) {
+      setError(error, "write to " + m_path + " failed");
+      return false;
+    }
+
+    // Centers exactly as the streaming engine reports them.
+    const std::string meta = jsonMetadata("", sampleRate, options.fftSize, options.logBins, options.hopMs,
+                                          LogBins::centers(sampleRate, options.logBins));
+
+    std::FILE* f = std::fopen((m_path + ".json").c_str(), "wb");
+    if (!f) {
+      setError(error, "cannot open " + m_path + ".json");
+      return false;
+    }
+    const bool ok = std::fwrite(meta.data(), 1, meta.size(), f) == meta.size();
+    return (std::fclose(f) == 0) && ok;
+  }
+
+  void close() {
+    if (m_file) std::fclose(m_file);
+    m_file = nullptr;
+  }
+
+private:
+  std::FILE* m_file = nullptr;
+  std::string m_path;
+  bool m_failed = false;
+};
+
+bool validOptions(int sampleRate, const BatchSpectrogram::Options& options, std::string* error) {
+  if (sampleRate <= 0 || options.fftSize < 2 || options.logBins <= 0 || options.hopMs <= 0 ||
+      options.framesPerChunk == 0) {
+    setError(error, "invalid batch options");
+    return false;
+  }
+  return true;
+}
+
+#if AUDIOENGINE_HAS_FLAC_DECODER
+// Pull-style wrapper around the FLAC stream decoder: one FLAC frame is
+// decoded whenever the buffered samples run out.
+class FlacReader final {
+public:
+  ~FlacReader() {
+    if (m_decoder) {
+      FLAC__stream_decoder_finish(m_decoder);
+      FLAC__stream_decoder_delete(m_decoder);
+    }
+  }
+
+  bool open(const std::string& path, std::string* error) {
+    m_decoder = FLAC__stream_decoder_new();
+    if (!m_decoder) {
+      setError(error, "cannot create FLAC decoder");
+      return false;
+    }
+    const FLAC__StreamDecoderInitStatus st = FLAC__stream_decoder_init_file(
+        m_decoder, path.c_str(), &FlacReader::onWrite, &FlacReader::onMetadata, &FlacReader::onError, this);
+    if (st != FLAC__STREAM_DECODER_INIT_STATUS_OK ||
+        !FLAC__stream_decoder_process_until_end_of_metadata(m_decoder) || m_sampleRate <= 0) {
+      setError(error, "cannot read FLAC stream " + path);
+      return false;
+    }
+    return true;
+  }
+
+  int sampleRate() const { return m_sampleRate; }
+
+  std::size_t read(float* dst, std::size_t max) {
+    while (m_pos == m_pending.size()) {
+      m_pending.clear();
+      m_pos = 0;
+      if (m_failed || FLAC__stream_decoder_get_state(m_decoder) == FLAC__STREAM_DECODER_END_OF_STREAM) return 0;
+      if (!FLAC__stream_decoder_process_single(m_decoder)) return 0;
+    }
+    const std::size_t n = std::min(max, m_pending.size() - m_pos);
+    std::copy(m_pending.begin() + static_cast<std::ptrdiff_t>(m_pos),
+              m_pending.begin() + static_cast<std::ptrdiff_t>(m_pos + n), dst);
+    m_pos += n;
+    return n;
+  }
+
+private:
+  static FLAC__StreamDecoderWriteStatus onWrite(
+      const FLAC__StreamDecoder*, const FLAC__Frame* frame, const FLAC__int32* const buffer[], void* user) {
+    auto* self = static_cast<FlacReader*>(user);
+    const unsigned channels = frame->header.channels;
+    const unsigned bits = frame->header.bits_per_sample;
+    // Inverse of the encoder's float -> int scaling in AudioEngine.
+    const float scale = 1.0f / static_cast<float>((1u << (bits - 1)) - 1u);
+    for (unsigned i = 0; i < frame->header.blocksize; ++i) {
+      float sum = 0.0f;
+      for (unsigned c = 0; c < channels; ++c) sum += static_cast<float>(buffer[c][i]) * scale;
+      self->m_pending.push_back(channels == 1 ? sum : sum / static_cast<float>(channels));
+    }
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+  }
+
+  static void onMetadata(const FLAC__StreamDecoder*, const FLAC__StreamMetadata* metadata, void* user) {
+    if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO)
+      static_cast<FlacReader*>(user)->m_sampleRate = static_cast<int>(metadata->data.stream_info.sample_rate);
+  }
+
+  static void onError(const FLAC__StreamDecoder*, FLAC__StreamDecoderErrorStatus, void* user) {
+    static_cast<FlacReader*>(user)->m_failed = true;
+  }
+
+  FLAC__StreamDecoder* m_decoder = nullptr;
+  int m_sampleRate = 0;
+  bool m_failed = false;
+  std::vector<float> m_pending;
+  std::size_t m_pos = 0;
+};
+#endif
+
+} // namespace
+
+std::size_t BatchSpectrogram::hopSamples(int sampleRate, int hopMs) {
+  const long long hop = static_cast<long long>(sampleRate) * hopMs / 1000;
+  return static_cast<std::size_t>(std::max(1LL, hop));
+}
+
+BatchSpectrogram::Result BatchSpectrogram::run(
+    int sampleRate, const SampleReader& read, const FrameSink& sink, const Options& options) {
+  using Clock = std::chrono::steady_clock;
+  const auto t0 = Clock::now();
+
+  Result result;
+  result.sampleRate = sampleRate;
+  result.logBins = options.logBins;
+  if (!validOptions(sampleRate, options, nullptr)) return result;
+
+  const dsp::Config cfg{sampleRate, options.fftSize, options.logBins};
+  const std::size_t n = static_cast<std::size_t>(options.fftSize);
+  const std::size_t hop = hopSamples(sampleRate, options.hopMs);
+  const std::size_t bins = static_cast<std::size_t>(options.logBins);
+  const long long window = static_cast<long long>(n);
+  const long long hopLen = static_cast<long long>(hop);
+
+  // Decoded samples from absolute position streamStart on; negative
+  // positions (before the recording) read as silence.
+  std::vector<float> stream;
+  long long streamStart = 0;
+  bool eof = false;
+  std::uint64_t totalSamples = 0;
+
+  auto fillTo = [&](long long end) {
+    while (!eof && streamStart + static_cast<long long>(stream.size()) < end) {
+      const std::size_t want = static_cast<std::size_t>(end - streamStart) - stream.size();
+      const std::size_t old = stream.size();
+      stream.resize(old + want);
+      const std::size_t got = read(stream.data() + old, want);
+      stream.resize(old + got);
+      totalSamples += got;
+      if (got == 0) eof = true;
+    }
+  };
+
+  // Idle analysis chains, one per concurrently running chunk.
+  std::mutex chainMutex;
+  std::vector<std::unique_ptr<dsp::LogBinChain>> idleChains;
+
+  std::mutex doneMutex;
+  std::condition_variable doneCv;
+  std::map<std::uint64_t, std::vector<float>> done;
+
+  WorkStealingPool pool(options.workers);
+  const std::size_t maxInFlight = pool.size() * 2;
+
+  std::uint64_t nextChunk = 0;
+  std::uint64_t nextToWrite = 0;
+  std::uint64_t nextFrame = 0;
+
+  auto drain = [&](std::size_t keepInFlight) {
+    while (nextChunk - nextToWrite > keepInFlight) {
+      std::vector<float> frames;
+      {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCv.wait(lock, [&] { return done.count(nextToWrite) != 0; });
+        frames = std::move(done[nextToWrite]);
+        done.erase(nextToWrite);
+      }
+      if (!frames.empty()) sink(frames.data(), frames.size() / bins);
+      result.frames += frames.size() / bins;
+      ++nextToWrite;
+    }
+  };
+
+  for (;;) {
+    const long long first = static_cast<long long>(nextFrame);
+    const long long begin = (first + 1) * hopLen - window;
+    fillTo((first + static_cast<long long>(options.framesPerChunk)) * hopLen);
+
+    // Only frames whose window ends inside the recording.
+    const long long available = streamStart + static_cast<long long>(stream.size());
+    const long long frameCount = std::min<long long>(
+        static_cast<long long>(options.framesPerChunk), available / hopLen - first);
+    if (frameCount <= 0) break;
+
+    const long long end = (first + frameCount) * hopLen;
+    auto chunk = std::make_shared<std::vector<float>>(static_cast<std::size_t>(end - begin), 0.0f);
+    for (long long p = std::max(begin, streamStart); p < end; ++p)
+      (*chunk)[static_cast<std::size_t>(p - begin)] = stream[static_cast<std::size_t>(p - streamStart)];
+
+    // Drop what the next chunk no longer needs.
+    const long long nextBegin = end + hopLen - window;
+    if (nextBegin > streamStart) {
+      const std::size_t drop = std::min(stream.size(), static_cast<std::size_t>(nextBegin - streamStart));
+      stream.erase(stream.begin(), stream.begin() + static_cast<std::ptrdiff_t>(drop));
+      streamStart += static_cast<long long>(drop);
+    }
+
+    const std::uint64_t index = nextChunk++;
+    const std::size_t frames = static_cast<std::size_t>(frameCount);
+    pool.submit([&, chunk, index, frames]() {
+      std::unique_ptr<dsp::LogBinChain> chain;
+      {
+        std::lock_guard<std::mutex> lock(chainMutex);
+        if (!idleChains.empty()) {
+          chain = std::move(idleChains.back());
+          idleChains.pop_back();
+        }
+      }
+      if (!chain) {
+        chain = std::make_unique<dsp::LogBinChain>();
+        chain->prepare(cfg);
+      }
+
+      std::vector<float> out(frames * bins);
+      for (std::size_t f = 0; f < frames; ++f) {
+        // The window of frame f is contiguous in the chunk: a full ring
+        // whose oldest sample is at index 0.
+        const auto& log = chain->run(dsp::RingView{chunk->data() + f * hop, n, 0});
+        std::copy(log.begin(), log.end(), out.begin() + static_cast<std::ptrdiff_t>(f * bins));
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(chainMutex);
+        idleChains.push_back(std::move(chain));
+      }
+      {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done[index] = std::move(out);
+      }
+      doneCv.notify_all();
+    });
+
+    nextFrame += static_cast<std::uint64_t>(frameCount);
+    drain(maxInFlight);
+  }
+  drain(0);
+
+  result.audioSeconds = static_cast<double>(totalSamples) / sampleRate;
+  result.wallSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+  return result;
+}
+
+bool BatchSpectrogram::processFlac(
+    const std::string& flacPath,
+    const std::string& outputPath,
+    const Options& options,
+    Result* result,
+    std::string* error) {
+#if AUDIOENGINE_HAS_FLAC_DECODER
+  FlacReader reader;
+  if (!reader.open(flacPath, error)) return false;
+  if (!validOptions(reader.sampleRate(), options, error)) return false;
+
+  FrameFileWriter writer;
+  if (!writer.open(outputPath, error)) return false;
+
+  const Result r = run(
+      reader.sampleRate(),
+      [&](float* dst, std::size_t max) { return reader.read(dst, max); },
+      [&](const float* frames, std::size_t count) { writer.write(frames, count * options.logBins); },
+      options);
+  if (result) *result = r;
+  return writer.finish(reader.sampleRate(), options, error);
+#else
+  (void)flacPath;
+  (void)outputPath;
+  (void)options;
+  (void)result;
+  setError(error, "built without FLAC support");
+  return false;
+#endif
+}
+
+bool BatchSpectrogram::processSamples(
+    const std::vector<float>& samples,
+    int sampleRate,
+    const std::string& outputPath,
+    const Options& options,
+    Result* result,
+    std::string* error) {
+  if (!validOptions(sampleRate, options, error)) return false;
+
+  FrameFileWriter writer;
+  if (!writer.open(outputPath, error)) return false;
+
+  std::size_t pos = 0;
+  const Result r = run(
+      sampleRate,
+      [&](float* dst, std::size_t max) {
+        const std::size_t count = std::min(max, samples.size() - pos);
+        std::copy(samples.begin() + static_cast<std::ptrdiff_t>(pos),
+                  samples.begin() + static_cast<std::ptrdiff_t>(pos + count), dst);
+        pos += count;
+        return count;
+      },
+      [&](const float* frames, std::size_t count) { writer.write(frames, count * options.logBins); },
+      options);
+  if (result) *result = r;
+  return writer.finish(sampleRate, options, error);
+}
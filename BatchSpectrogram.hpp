@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Offline spectrogram of a recording (e.g. a FLAC file written by
+// AudioEngine) on all cores.
+// - The input is cut into chunks of framesPerChunk hops; consecutive chunks
+//   overlap by fftSize - hop samples so every frame sees its full window.
+// - Chunks run on a WorkStealingPool through the same dsp::LogBinChain as
+//   AudioEngine::processHop(); frames are delivered in order.
+//
+// Frame k is the analysis of the fftSize samples ending at sample
+// (k + 1) * hop, with silence before the start of the file. This is exactly
+// what a dynamic AudioEngine publishes when the recording is pushed through
+// pushSamples() one hop at a time, so the output is bit-identical to the
+// streaming path.
+class BatchSpectrogram final {
+public:
+  struct Options {
+    int fftSize = 2048;
+    int logBins = 64;
+    int hopMs = 50;
+    int workers = 0;                   // <= 0: one per core
+    std::size_t framesPerChunk = 512;
+  };
+
+  struct Result {
+    int sampleRate = 0;
+    int logBins = 0;
+    std::uint64_t frames = 0;
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+
+    double audioSecondsPerWallSecond() const { return wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0; }
+  };
+
+  // Fills up to max mono samples; returns 0 at the end of the input.
+  using SampleReader = std::function<std::size_t(float* dst, std::size_t max)>;
+  // Receives count consecutive frames of logBins floats each, in order.
+  using FrameSink = std::function<void(const float* frames, std::size_t count)>;
+
+  // Hop length in samples used for hopMs (as the streaming engine's timer).
+  static std::size_t hopSamples(int sampleRate, int hopMs);
+
+  static Result run(int sampleRate, const SampleReader& read, const FrameSink& sink, const Options& options);
+
+  // Decodes a FLAC file (downmixed to mono) and writes the frames to
+  // outputPath as raw native-endian float32, logBins values per frame. A
+  // metadata message (jsonMetadata(), with the centers) is written next to it
+  // as outputPath + ".json". Returns false if FLAC support is not built in or
+  // a file cannot be opened.
+  static bool processFlac(
+      const std::string& flacPath,
+      const std::string& outputPath,
+      const Options& options,
+      Result* result = nullptr,
+      std::string* error = nullptr);
+
+  // Same output files for samples already in memory.
+  static bool processSamples(
+      const std::vector<float>& samples,
+      int sampleRate,
+      const std::string& outputPath,
+      const Options& options,
+      Result* result = nullptr,
+      std::string* error = nullptr);
+};
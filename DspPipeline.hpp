@@ -0,0 +1,362 @@
+#pragma once
+
+#include "Fft.hpp"
+#include "LogBins.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Composable analysis pipeline built from typed stages.
+//
+// Every stage declares input_type / output_type, a StageKind, prepare() (called
+// once per configuration, allocates everything) and outputSize(). The kind
+// decides how the stage touches memory:
+//
+// - Block:  opaque process(in, out), e.g. the FFT
+// - Source: forEach(in, sink) produces one float per output index
+// - Map:    map(x, i) transforms one float in place of its index
+// - Reduce: begin(out) / accept(out, i, x) / finish(out) folds a float stream
+//
+// Source/Map/Reduce stages can run on their own (one pass each, one buffer per
+// stage) or be combined with Fuse<...> into a single pass without intermediate
+// buffers. Both forms evaluate the same expressions in the same order, so their
+// results are bit-identical.
+namespace dsp {
+
+struct Config {
+    int sampleRate;
+    int fftSize;
+    int logBins;
+};
+
+enum class StageKind { Block, Source, Map, Reduce };
+
+// Read-only view of the capture ring. writeIdx is the next slot to be written,
+// i.e. the oldest sample once the ring has filled.
+struct RingView {
+    const float* data;
+    std::size_t size;
+    std::size_t writeIdx;
+};
+
+inline float hannWindow(int i, int n) {
+    constexpr float kPi = 3.14159265358979323846f;
+    return 0.5f - 0.5f * std::cos(2.0f * kPi * static_cast<float>(i) / static_cast<float>(n - 1));
+}
+
+// Copies the most recent fftSize samples out of the capture ring in
+// chronological order (two contiguous segments, no per-sample modulo).
+class Snapshot {
+public:
+    using input_type = RingView;
+    using output_type = std::vector<float>;
+    static constexpr StageKind kind = StageKind::Source;
+
+    void prepare(const Config& cfg) { m_size = static_cast<std::size_t>(cfg.fftSize); }
+    std::size_t outputSize(const Config& cfg) const { return static_cast<std::size_t>(cfg.fftSize); }
+
+    template <typename Sink>
+    void forEach(const RingView& in, Sink&& sink) const {
+        const std::size_t n = std::min(m_size, in.size);
+        const std::size_t start = (in.writeIdx + in.size - n) % in.size;
+        const std::size_t first = std::min(n, in.size - start);
+        for (std::size_t i = 0; i < first; ++i) sink(i, in.data[start + i]);
+        for (std::size_t i = first; i < n; ++i) sink(i, in.data[i - first]);
+    }
+
+private:
+    std::size_t m_size{0};
+};
+
+// Multiplies by a precomputed Hann window.
+class Window {
+public:
+    using input_type = std::vector<float>;
+    using output_type = std::vector<float>;
+    static constexpr StageKind kind = StageKind::Map;
+
+    void prepare(const Config& cfg) {
+        m_window.resize(static_cast<std::size_t>(cfg.fftSize));
+        for (int i = 0; i < cfg.fftSize; i++)
+            m_window[static_cast<std::size_t>(i)] = hannWindow(i, cfg.fftSize);
+    }
+    std::size_t outputSize(const Config& cfg) const { return static_cast<std::size_t>(cfg.fftSize); }
+
+    float map(float x, std::size_t i) const { return x * m_window[i]; }
+
+private:
+    std::vector<float> m_window;
+};
+
+class ForwardFft {
+public:
+    using input_type = std::vector<float>;
+    using output_type = std::vector<FftComplex>;
+    static constexpr StageKind kind = StageKind::Block;
+
+    void prepare(const Config& cfg) {
+        if (!m_fft || m_fft->size() != cfg.fftSize) m_fft = std::make_unique<RealFft>(cfg.fftSize);
+    }
+    std::size_t outputSize(const Config& cfg) const { return static_cast<std::size_t>(cfg.fftSize / 2 + 1); }
+
+    void process(const input_type& in, output_type& out) { m_fft->forward(in.data(), out.data()); }
+
+private:
+    std::unique_ptr<RealFft> m_fft;
+};
+
+// |X[k]| for k in [0, fftSize / 2) (the Nyquist bin is dropped, as before).
+class Magnitude {
+public:
+    using input_type = std::vector<FftComplex>;
+    using output_type = std::vector<float>;
+    static constexpr StageKind kind = StageKind::Source;
+
+    void prepare(const Config& cfg) { m_size = static_cast<std::size_t>(cfg.fftSize / 2); }
+    std::size_t outputSize(const Config& cfg) const { return static_cast<std::size_t>(cfg.fftSize / 2); }
+
+    template <typename Sink>
+    void forEach(const input_type& in, Sink&& sink) const {
+        for (std::size_t i = 0; i < m_size; ++i) {
+            const float r = in[i].r;
+            const float im = in[i].i;
+            sink(i, std::sqrt(r * r + im * im));
+        }
+    }
+
+private:
+    std::size_t m_size{0};
+};
+
+// Magnitude to dB (20 * log10), floored to avoid -inf on silence.
+class Decibels {
+public:
+    using input_type = std::vector<float>;
+    using output_type = std::vector<float>;
+    static constexpr StageKind kind = StageKind::Map;
+
+    void prepare(const Config&) {}
+    std::size_t outputSize(const Config& cfg) const { return static_cast<std::size_t>(cfg.fftSize / 2); }
+
+    float map(float x, std::size_t) const { return 20.0f * std::log10(std::max(x, 1e-10f)); }
+};
+
+// Averages FFT bins into log-spaced bands (same ranges and summation order as
+// LogBins::compute). The bands covering one FFT bin are contiguous, so each
+// input value is added to a precomputed [firstBand, lastBand] span.
+class LogBinAverage {
+public:
+    using input_type = std::vector<float>;
+    using output_type = std::vector<float>;
+    static constexpr StageKind kind = StageKind::Reduce;
+
+    void prepare(const Config& cfg) {
+        const int magSize = cfg.fftSize / 2;
+        const auto ranges = LogBins::ranges(cfg.sampleRate, cfg.fftSize, cfg.logBins, magSize);
+
+        m_count.assign(ranges.size(), 0);
+        m_firstBand.assign(static_cast<std::size_t>(magSize), 0);
+        m_lastBand.assign(static_cast<std::size_t>(magSize), -1);
+
+        for (int b = 0; b < static_cast<int>(ranges.size()); ++b) {
+            const auto& r = ranges[static_cast<std::size_t>(b)];
+            m_count[static_cast<std::size_t>(b)] = std::max(0, r.second - r.first + 1);
+            for (int k = r.first; k <= r.second; ++k) {
+                const std::size_t ks = static_cast<std::size_t>(k);
+                if (m_lastBand[ks] < 0) m_firstBand[ks] = b;
+                m_lastBand[ks] = b;
+            }
+        }
+    }
+    std::size_t outputSize(const Config& cfg) const { return static_cast<std::size_t>(cfg.logBins); }
+
+    void begin(output_type& out) const { std::fill(out.begin(), out.end(), 0.0f); }
+
+    void accept(output_type& out, std::size_t k, float x) const {
+        if (k >= m_lastBand.size()) return;
+        for (int b = m_firstBand[k]; b <= m_lastBand[k]; ++b) out[static_cast<std::size_t>(b)] += x;
+    }
+
+    void finish(output_type& out) const {
+        for (std::size_t b = 0; b < out.size(); ++b) {
+            const int count = m_count[b];
+            out[b] = (count > 0) ? out[b] / count : 0.0f;
+        }
+    }
+
+private:
+    std::vector<int> m_count;
+    std::vector<int> m_firstBand;
+    std::vector<int> m_lastBand;
+};
+
+// Runs one stage on its own, materializing its output buffer.
+template <typename Stage>
+void runStage(Stage& stage, const typename Stage::input_type& in, typename Stage::output_type& out) {
+    if constexpr (Stage::kind == StageKind::Block) {
+        stage.process(in, out);
+    } else if constexpr (Stage::kind == StageKind::Source) {
+        stage.forEach(in, [&out](std::size_t i, float x) { out[i] = x; });
+    } else if constexpr (Stage::kind == StageKind::Map) {
+        const std::size_t n = std::min(in.size(), out.size());
+        for (std::size_t i = 0; i < n; ++i) out[i] = stage.map(in[i], i);
+    } else {
+        stage.begin(out);
+        for (std::size_t i = 0; i < in.size(); ++i) stage.accept(out, i, in[i]);
+        stage.finish(out);
+    }
+}
+
+// Fuses adjacent element-wise stages into a single pass:
+//   Fuse<Source|Map, Map..., Map|Reduce>
+// The head produces values, the maps transform them in registers and the tail
+// either stores them or folds them into its output.
+template <typename Head, typename... Tail>
+class Fuse {
+    using Stages = std::tuple<Head, Tail...>;
+    static constexpr std::size_t kCount = 1 + sizeof...(Tail);
+    using Last = std::tuple_element_t<kCount - 1, Stages>;
+    static constexpr bool kReduces = Last::kind == StageKind::Reduce;
+
+    static_assert(sizeof...(Tail) > 0, "Fuse needs at least two stages");
+    static_assert(Head::kind == StageKind::Source || Head::kind == StageKind::Map,
+                  "Fuse must start with a Source or Map stage");
+    static_assert(((Tail::kind == StageKind::Map || Tail::kind == StageKind::Reduce) && ...),
+                  "Only Map stages (and a final Reduce) can follow the head");
+
+public:
+    using input_type = typename Head::input_type;
+    using output_type = typename Last::output_type;
+    static constexpr StageKind kind = StageKind::Block;
+
+    void prepare(const Config& cfg) {
+        std::apply([&cfg](auto&... s) { (s.prepare(cfg), ...); }, m_stages);
+    }
+    std::size_t outputSize(const Config& cfg) const { return std::get<kCount - 1>(m_stages).outputSize(cfg); }
+
+    void process(const input_type& in, output_type& out) {
+        if constexpr (kReduces) {
+            const Last& last = std::get<kCount - 1>(m_stages);
+            last.begin(out);
+            produce(in, [&](std::size_t i, float x) { last.accept(out, i, mapFrom<1>(x, i)); });
+            last.finish(out);
+        } else {
+            produce(in, [&](std::size_t i, float x) { out[i] = mapFrom<1>(x, i); });
+        }
+    }
+
+    template <std::size_t I>
+    auto& stage() { return std::get<I>(m_stages); }
+
+private:
+    template <typename Sink>
+    void produce(const input_type& in, Sink&& sink) const {
+        const Head& head = std::get<0>(m_stages);
+        if constexpr (Head::kind == StageKind::Source) {
+            head.forEach(in, sink);
+        } else {
+            for (std::size_t i = 0; i < in.size(); ++i) sink(i, head.map(in[i], i));
+        }
+    }
+
+    template <std::size_t I>
+    float mapFrom(float x, std::size_t i) const {
+        if constexpr (I >= kCount) {
+            return x;
+        } else {
+            using S = std::tuple_element_t<I, Stages>;
+            if constexpr (S::kind == StageKind::Map)
+                return mapFrom<I + 1>(std::get<I>(m_stages).map(x, i), i);
+            else
+                return x;
+        }
+    }
+
+    Stages m_stages;
+};
+
+// A chain of stages with one preallocated output buffer per stage.
+// prepare() sizes everything; run() does not allocate.
+template <typename... Stages>
+class Pipeline {
+    static_assert(sizeof...(Stages) > 0, "Pipeline needs at least one stage");
+
+    using StageTuple = std::tuple<Stages...>;
+    static constexpr std::size_t kCount = sizeof...(Stages);
+
+    template <std::size_t... I>
+    static constexpr bool chained(std::index_sequence<I...>) {
+        return (std::is_same<typename std::tuple_element_t<I, StageTuple>::output_type,
+                             typename std::tuple_element_t<I + 1, StageTuple>::input_type>::value && ...);
+    }
+    static_assert(chained(std::make_index_sequence<kCount - 1>{}),
+                  "Each stage's output_type must match the next stage's input_type");
+
+public:
+    using input_type = typename std::tuple_element_t<0, StageTuple>::input_type;
+    using output_type = typename std::tuple_element_t<kCount - 1, StageTuple>::output_type;
+
+    void prepare(const Config& cfg) {
+        prepareFrom<0>(cfg);
+        m_config = cfg;
+    }
+
+    // Runs only the first stage, e.g. while holding the capture lock.
+    void runHead(const input_type& in) { runStage(std::get<0>(m_stages), in, std::get<0>(m_buffers)); }
+
+    // Runs the remaining stages on the head's output.
+    const output_type& runTail() {
+        runFrom<1>();
+        return std::get<kCount - 1>(m_buffers);
+    }
+
+    const output_type& run(const input_type& in) {
+        runHead(in);
+        return runTail();
+    }
+
+    const output_type& output() const { return std::get<kCount - 1>(m_buffers); }
+    const Config& config() const { return m_config; }
+
+    template <std::size_t I>
+    auto& stage() { return std::get<I>(m_stages); }
+
+private:
+    template <std::size_t I>
+    void prepareFrom(const Config& cfg) {
+        if constexpr (I < kCount) {
+            auto& s = std::get<I>(m_stages);
+            s.prepare(cfg);
+            std::get<I>(m_buffers).assign(s.outputSize(cfg), {});
+            prepareFrom<I + 1>(cfg);
+        }
+    }
+
+    template <std::size_t I>
+    void runFrom() {
+        if constexpr (I < kCount) {
+            runStage(std::get<I>(m_stages), std::get<I - 1>(m_buffers), std::get<I>(m_buffers));
+            runFrom<I + 1>();
+        }
+    }
+
+    StageTuple m_stages;
+    std::tuple<typename Stages::output_type...> m_buffers;
+    Config m_config{};
+};
+
+// The engine's analysis chain: snapshot, Hann window, FFT, magnitude, log-bin
+// average. The unfused form is kept for tests and benchmarks.
+using UnfusedLogBinChain = Pipeline<Snapshot, Window, ForwardFft, Magnitude, LogBinAverage>;
+using LogBinChain = Pipeline<Fuse<Snapshot, Window>, ForwardFft, Fuse<Magnitude, LogBinAverage>>;
+
+// Same chain with log bins averaged in dB instead of linear magnitude.
+using DecibelLogBinChain = Pipeline<Fuse<Snapshot, Window>, ForwardFft, Fuse<Magnitude, Decibels, LogBinAverage>>;
+
+} // namespace dsp
@@ -0,0 +1,163 @@
+#include "EngineHost.hpp"
+
+#include "JsonFormat.hpp"
+
+#include <algorithm>
+
+EngineHost::EngineHost(int workers) : m_pool(workers) {}
+
+EngineHost::~EngineHost() { stop(); }
+
+AudioEngine& EngineHost::addEngine(const std::string& sourceId, std::unique_ptr<AudioEngine> engine, int hopMs) {
+  auto src = std::make_unique<Source>();
+  src->id = sourceId;
+  src->engine = std::move(engine);
+  src->hop = std::chrono::milliseconds(std::max(1, hopMs));
+  const auto info = src->engine->getInfo();
+  src->framePrefix = framePrefix_(sourceId, info.centers);
+  src->configVersion = info.version;
+  src->stats.sourceId = sourceId;
+
+  AudioEngine& ref = *src->engine;
+  m_sources.push_back(std::move(src));
+  return ref;
+}
+
+std::string EngineHost::framePrefix_(const std::string& sourceId, const std::vector<float>& centers) {
+  return "{\"source\":" + jsonString(sourceId) +
+         ",\"centers\":" + jsonArray(centers) +
+         ",\"seq\":";
+}
+
+void EngineHost::setFrameCallback(FrameCallback cb) { m_frameCallback = std::move(cb); }
+
+void EngineHost::start(int port) {
+  if (m_running.load()) return;
+
+  if (port >= 0) {
+    m_server = std::make_unique<WebSocketServer>(port);
+    m_server->start();
+  }
+
+  const auto now = Clock::now();
+  for (auto& src : m_sources) {
+    src->engine->startHosted();
+    src->nextTick = now + src->hop;
+  }
+
+  m_running = true;
+  m_scheduler = std::thread(&EngineHost::schedulerLoop_, this);
+}
+
+void EngineHost::stop() {
+  {
+    std::lock_guard<std::mutex> lk(m_schedMutex);
+    if (!m_running.exchange(false)) return;
+  }
+  m_schedCv.notify_all();
+  if (m_scheduler.joinable()) m_scheduler.join();
+
+  // Let submitted hops finish before the engines go away.
+  {
+    std::unique_lock<std::mutex> lk(m_schedMutex);
+    m_idleCv.wait(lk, [this] { return m_inFlight.load() == 0; });
+  }
+
+  if (m_server) {
+    m_server->stop();
+    m_server.reset();
+  }
+  for (auto& src : m_sources) src->engine->stop();
+}
+
+std::vector<EngineHost::SourceStats> EngineHost::stats() const {
+  std::vector<SourceStats> out;
+  out.reserve(m_sources.size());
+  for (const auto& src : m_sources) {
+    std::lock_guard<std::mutex> lk(src->statsMutex);
+    out.push_back(src->stats);
+  }
+  return out;
+}
+
+void EngineHost::schedulerLoop_() {
+  while (m_running.load()) {
+    const auto now = Clock::now();
+    auto wakeAt = now + std::chrono::seconds(1);
+
+    for (auto& srcPtr : m_sources) {
+      Source& src = *srcPtr;
+      if (now >= src.nextTick) {
+        const auto deadline = src.nextTick + src.hop;
+
+        if (src.busy.exchange(true)) {
+          std::lock_guard<std::mutex> lk(src.statsMutex);
+          ++src.stats.skippedHops;
+        } else {
+          ++m_inFlight;
+          m_pool.submit([this, &src, deadline] { runHop_(src, deadline); });
+        }
+
+        // Keep the cadence; ticks missed entirely (scheduler stalled) are skipped.
+        src.nextTick += src.hop;
+        while (src.nextTick <= now) {
+          src.nextTick += src.hop;
+          std::lock_guard<std::mutex> lk(src.statsMutex);
+          ++src.stats.skippedHops;
+        }
+      }
+      wakeAt = std::min(wakeAt, src.nextTick);
+    }
+
+    std::unique_lock<std::mutex> lk(m_schedMutex);
+    m_schedCv.wait_until(lk, wakeAt, [this] { return !m_running.load(); });
+  }
+}
+
+void EngineHost::runHop_(Source& src, Clock::time_point deadline) {
+  src.engine->runHop();
+  const auto bins = src.engine->getLogBins();
+  const auto done = Clock::now();
+
+  const std::uint64_t seq = src.seq++;
+  {
+    const double latenessMs = std::chrono::duration<double, std::milli>(done - deadline).count();
+    std::lock_guard<std::mutex> lk(src.statsMutex);
+    ++src.stats.hops;
+    if (latenessMs > 0.0) {
+      ++src.stats.lateHops;
+      src.stats.maxLatenessMs = std::max(src.stats.maxLatenessMs, latenessMs);
+    }
+  }
+
+  if (m_frameCallback) m_frameCallback(src.id, bins);
+
+  if (m_server) {
+    if (src.engine->getConfigVersion() != src.configVersion) {
+      // Hosted engines hop on the host's interval, so report that one.
+      const auto info = src.engine->getInfo();
+      src.configVersion = info.version;
+      src.framePrefix = framePrefix_(src.id, info.centers);
+      m_server->broadcast(jsonMetadata(src.id, info.sampleRate, info.fftSize, info.logBins,
+                                       static_cast<int>(src.hop.count()), info.centers));
+    }
+
+    const auto ts = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    std::string frame = src.framePrefix;
+    frame += std::to_string(seq);
+    frame += ",\"ts\":";
+    frame += std::to_string(ts.count());
+    frame += ",\"bins\":";
+    frame += jsonArray(bins);
+    frame += '}';
+    m_server->broadcast(std::move(frame));
+  }
+
+  src.busy.store(false);
+  if (--m_inFlight == 0) {
+    // Under the lock so stop() cannot miss the wakeup between check and wait.
+    std::lock_guard<std::mutex> lk(m_schedMutex);
+    m_idleCv.notify_all();
+  }
+}
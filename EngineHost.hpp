@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioEngine.hpp"
+#include "WebSocketServer.hpp"
+#include "WorkStealingPool.hpp"
+
+// Runs the analysis hops of many AudioEngine instances on one shared
+// WorkStealingPool instead of one thread per engine.
+// - Each engine has its own hop interval; a single scheduler thread submits a
+//   hop when it is due. Its deadline is the next tick: finishing after it
+//   counts as late, and a tick that finds the previous hop still running is
+//   skipped rather than queued.
+// - Optionally serves one multiplexed WebSocket endpoint where every frame is
+//   tagged with its source id:
+//     {"source":"<id>","centers":[...],"seq":N,"ts":T,"bins":[...]}
+//   where ts is the time the hop finished, in microseconds since the Unix
+//   epoch (lets clients measure delivery latency),
+//   and a {"type":"meta","source":"<id>",...} message whenever an engine is
+//   reconfigured.
+//
+// Engines are added before start() and owned by the host.
+class EngineHost final {
+public:
+  using FrameCallback = std::function<void(const std::string& sourceId, const std::vector<float>& bins)>;
+
+  struct SourceStats {
+    std::string sourceId;
+    std::uint64_t hops = 0;
+    std::uint64_t lateHops = 0;
+    std::uint64_t skippedHops = 0;
+    double maxLatenessMs = 0.0;
+  };
+
+  // workers <= 0 sizes the pool to the core count.
+  explicit EngineHost(int workers = 0);
+  ~EngineHost();
+
+  EngineHost(const EngineHost&) = delete;
+  EngineHost& operator=(const EngineHost&) = delete;
+
+  AudioEngine& addEngine(const std::string& sourceId, std::unique_ptr<AudioEngine> engine, int hopMs = 50);
+
+  // Called on a pool worker after every hop (before the WebSocket broadcast).
+  void setFrameCallback(FrameCallback cb);
+
+  // port < 0: no WebSocket endpoint.
+  void start(int port = -1);
+  void stop();
+
+  std::vector<SourceStats> stats() const;
+  std::size_t workerCount() const noexcept { return m_pool.size(); }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Source {
+    std::string id;
+    std::unique_ptr<AudioEngine> engine;
+    std::chrono::milliseconds hop{50};
+    std::string framePrefix; // {"source":..,"centers":[..],"seq":
+    Clock::time_point nextTick{};
+    std::atomic<bool> busy{false};
+    std::uint64_t seq = 0;
+    std::uint64_t configVersion = 0;
+
+    mutable std::mutex statsMutex;
+    SourceStats stats;
+  };
+
+  void schedulerLoop_();
+  void runHop_(Source& src, Clock::time_point deadline);
+  static std::string framePrefix_(const std::string& sourceId, const std::vector<float>& centers);
+
+  WorkStealingPool m_pool;
+  std::vector<std::unique_ptr<Source>> m_sources;
+
+  FrameCallback m_frameCallback;
+  std::unique_ptr<WebSocketServer> m_server;
+
+  std::atomic<bool> m_running{false};
+  std::atomic<int> m_inFlight{0};
+  std::thread m_scheduler;
+  std::mutex m_schedMutex;
+  std::condition_variable m_schedCv;
+  std::condition_variable m_idleCv; // m_inFlight reached 0
+};
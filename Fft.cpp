@@ -0,0 +1,157 @@
+#include "Fft.hpp"
+
+#include <cmath>
+#include <cstdlib>
+
+#if __has_include(<kissfft/kiss_fftr.h>)
+#include <kissfft/kiss_fft.h>
+#include <kissfft/kiss_fftr.h>
+#define AUDIOENGINE_HAS_KISSFFT 1
+#else
+#define AUDIOENGINE_HAS_KISSFFT 0
+#endif
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+bool isPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+#if !AUDIOENGINE_HAS_KISSFFT
+std::vector<FftComplex> makeTwiddles(int size) {
+    const std::size_t n = static_cast<std::size_t>(size);
+    std::vector<FftComplex> out(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        const double ph = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(n);
+        out[k] = FftComplex{static_cast<float>(std::cos(ph)), static_cast<float>(std::sin(ph))};
+    }
+    return out;
+}
+
+// Empty unless size is a power of two.
+std::vector<int> makeBitReverse(int size) {
+    std::vector<int> out;
+    if (!isPowerOfTwo(size)) return out;
+    int bits = 0;
+    while ((1 << bits) < size) ++bits;
+    out.resize(static_cast<std::size_t>(size));
+    for (int i = 0; i < size; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b)
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        out[static_cast<std::size_t>(i)] = r;
+    }
+    return out;
+}
+
+// Iterative radix-2 decimation-in-time on bit-reversed input, in place.
+void butterflies(FftComplex* a, std::size_t n, const std::vector<FftComplex>& twiddles) {
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        const std::size_t step = n / len;
+        const std::size_t halfLen = len / 2;
+        for (std::size_t start = 0; start < n; start += len) {
+            for (std::size_t j = 0; j < halfLen; ++j) {
+                const FftComplex& w = twiddles[j * step];
+                FftComplex& u = a[start + j];
+                FftComplex& v = a[start + j + halfLen];
+                const float tr = v.r * w.r - v.i * w.i;
+                const float ti = v.r * w.i + v.i * w.r;
+                v = FftComplex{u.r - tr, u.i - ti};
+                u = FftComplex{u.r + tr, u.i + ti};
+            }
+        }
+    }
+}
+#endif
+} // namespace
+
+#if AUDIOENGINE_HAS_KISSFFT
+static_assert(sizeof(FftComplex) == sizeof(kiss_fft_cpx), "FftComplex must match kiss_fft_cpx");
+#endif
+
+RealFft::RealFft(int fftSize) : m_size(fftSize > 1 ? fftSize : 2) {
+#if AUDIOENGINE_HAS_KISSFFT
+    m_kissCfg = kiss_fftr_alloc(m_size, 0, nullptr, nullptr);
+#else
+    m_twiddles = makeTwiddles(m_size);
+    m_bitReverse = makeBitReverse(m_size);
+    m_scratch.resize(static_cast<std::size_t>(m_size));
+#endif
+}
+
+RealFft::~RealFft() {
+#if AUDIOENGINE_HAS_KISSFFT
+    std::free(m_kissCfg);
+#endif
+}
+
+void RealFft::forward(const float* in, FftComplex* out) {
+#if AUDIOENGINE_HAS_KISSFFT
+    kiss_fftr(static_cast<kiss_fftr_cfg>(m_kissCfg), in, reinterpret_cast<kiss_fft_cpx*>(out));
+#else
+    const std::size_t n = static_cast<std::size_t>(m_size);
+    const std::size_t half = n / 2;
+
+    if (m_bitReverse.empty()) {
+        // Plain DFT for sizes that are not a power of two.
+        for (std::size_t k = 0; k <= half; ++k) {
+            float re = 0.0f;
+            float im = 0.0f;
+            for (std::size_t j = 0; j < n; ++j) {
+                const FftComplex& w = m_twiddles[(j * k) % n];
+                re += in[j] * w.r;
+                im += in[j] * w.i;
+            }
+            out[k] = FftComplex{re, im};
+        }
+        return;
+    }
+
+    FftComplex* a = m_scratch.data();
+    for (std::size_t i = 0; i < n; ++i)
+        a[m_bitReverse[i]] = FftComplex{in[i], 0.0f};
+    butterflies(a, n, m_twiddles);
+
+    for (std::size_t k = 0; k <= half; ++k) out[k] = a[k];
+#endif
+}
+
+ComplexFft::ComplexFft(int fftSize) : m_size(fftSize > 1 ? fftSize : 2) {
+#if AUDIOENGINE_HAS_KISSFFT
+    m_kissCfg = kiss_fft_alloc(m_size, 0, nullptr, nullptr);
+#else
+    m_twiddles = makeTwiddles(m_size);
+    m_bitReverse = makeBitReverse(m_size);
+#endif
+}
+
+ComplexFft::~ComplexFft() {
+#if AUDIOENGINE_HAS_KISSFFT
+    std::free(m_kissCfg);
+#endif
+}
+
+void ComplexFft::forward(const FftComplex* in, FftComplex* out) {
+#if AUDIOENGINE_HAS_KISSFFT
+    kiss_fft(static_cast<kiss_fft_cfg>(m_kissCfg), reinterpret_cast<const kiss_fft_cpx*>(in),
+             reinterpret_cast<kiss_fft_cpx*>(out));
+#else
+    const std::size_t n = static_cast<std::size_t>(m_size);
+
+    if (m_bitReverse.empty()) {
+        for (std::size_t k = 0; k < n; ++k) {
+            float re = 0.0f;
+            float im = 0.0f;
+            for (std::size_t j = 0; j < n; ++j) {
+                const FftComplex& w = m_twiddles[(j * k) % n];
+                re += in[j].r * w.r - in[j].i * w.i;
+                im += in[j].r * w.i + in[j].i * w.r;
+            }
+            out[k] = FftComplex{re, im};
+        }
+        return;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) out[m_bitReverse[i]] = in[i];
+    butterflies(out, n, m_twiddles);
+#endif
+}
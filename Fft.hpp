@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+// Complex FFT output bin. Layout-compatible with kiss_fft_cpx so results can
+// be written by kissfft without copying.
+struct FftComplex {
+    float r;
+    float i;
+};
+
+// Forward real-input FFT of a fixed size.
+// - Uses kissfft (kiss_fftr) when its headers are available
+// - Otherwise falls back to a small built-in radix-2 FFT (or a plain DFT for
+//   sizes that are not a power of two), so the engine still produces spectra
+//
+// forward() reads size() samples and writes size() / 2 + 1 bins.
+class RealFft {
+public:
+    explicit RealFft(int fftSize);
+    ~RealFft();
+
+    RealFft(const RealFft&) = delete;
+    RealFft& operator=(const RealFft&) = delete;
+
+    int size() const noexcept { return m_size; }
+
+    void forward(const float* in, FftComplex* out);
+
+private:
+    int m_size;
+    void* m_kissCfg{nullptr};
+
+    // Built-in fallback state.
+    std::vector<FftComplex> m_twiddles;
+    std::vector<int> m_bitReverse;
+    std::vector<FftComplex> m_scratch;
+};
+
+// Forward complex FFT of a fixed size (same backends as RealFft).
+// forward() reads and writes size() bins; in and out must not alias.
+class ComplexFft {
+public:
+    explicit ComplexFft(int fftSize);
+    ~ComplexFft();
+
+    ComplexFft(const ComplexFft&) = delete;
+    ComplexFft& operator=(const ComplexFft&) = delete;
+
+    int size() const noexcept { return m_size; }
+
+    void forward(const FftComplex* in, FftComplex* out);
+
+private:
+    int m_size;
+    void* m_kissCfg{nullptr};
+
+    std::vector<FftComplex> m_twiddles;
+    std::vector<int> m_bitReverse;
+};
@@ -0,0 +1,8 @@
+#include "FixedAudioEngine.hpp"
+
+template class FixedAudioEngine<44100, 1024, 64>;
+template class FixedAudioEngine<44100, 2048, 128>;
+template class FixedAudioEngine<44100, 4096, 128>;
+template class FixedAudioEngine<48000, 1024, 64>;
+template class FixedAudioEngine<48000, 2048, 128>;
+template class FixedAudioEngine<48000, 4096, 128>;
@@ -0,0 +1,332 @@
+#pragma once
+
+#include "AudioEngine.hpp"
+#include "DspPipeline.hpp"
+#include "Fft.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+// Compile-time specialised analysis for a fixed sample rate / FFT size / bin
+// count. Window, FFT and log-bin tables are generated at compile time and all
+// buffers are std::array, so every loop has a constant trip count.
+namespace dsp {
+namespace ct {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kLn2 = 0.69314718055994530942;
+
+constexpr double abs(double x) { return x < 0.0 ? -x : x; }
+
+constexpr double cos(double x) {
+    while (x > kPi) x -= 2.0 * kPi;
+    while (x < -kPi) x += 2.0 * kPi;
+    const double x2 = x * x;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 24; ++n) {
+        term *= -x2 / static_cast<double>((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double sin(double x) { return cos(kPi / 2.0 - x); }
+
+constexpr double exp(double x) {
+    int halvings = 0;
+    while (abs(x) > 0.125) {
+        x *= 0.5;
+        ++halvings;
+    }
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 20; ++n) {
+        term *= x / n;
+        sum += term;
+    }
+    while (halvings-- > 0) sum *= sum;
+    return sum;
+}
+
+// Natural log for x > 0: x = m * 2^e with m in [1, 2), then atanh series.
+constexpr double log(double x) {
+    int e = 0;
+    while (x >= 2.0) { x *= 0.5; ++e; }
+    while (x < 1.0) { x *= 2.0; --e; }
+    const double y = (x - 1.0) / (x + 1.0);
+    const double y2 = y * y;
+    double term = y;
+    double sum = 0.0;
+    for (int n = 1; n < 80; n += 2) {
+        sum += term / n;
+        term *= y2;
+    }
+    return 2.0 * sum + e * kLn2;
+}
+
+constexpr float pow(float base, float exponent) {
+    return static_cast<float>(exp(static_cast<double>(exponent) * log(static_cast<double>(base))));
+}
+
+constexpr int floorToInt(float x) {
+    const int i = static_cast<int>(x);
+    return (static_cast<float>(i) > x) ? i - 1 : i;
+}
+
+constexpr int ceilToInt(float x) {
+    const int i = static_cast<int>(x);
+    return (static_cast<float>(i) < x) ? i + 1 : i;
+}
+
+} // namespace ct
+
+// Real-input FFT of a fixed power-of-two size: a radix-2 complex FFT of
+// size / 2 over the samples packed as (even, odd) pairs, then one pass that
+// splits the result into the size / 2 + 1 real-input bins. Twiddle and
+// bit-reversal tables are compile-time constants.
+template <int Size>
+class FixedRealFft {
+    static_assert(Size >= 4 && (Size & (Size - 1)) == 0, "FixedRealFft needs a power of two of at least 4");
+
+public:
+    static constexpr int kHalf = Size / 2;
+
+    struct Tables {
+        std::array<FftComplex, kHalf> twiddles{}; // e^(-2 pi i k / Size)
+        std::array<int, kHalf> bitReverse{};
+
+        static constexpr Tables make() {
+            Tables t{};
+            for (int k = 0; k < kHalf; k++) {
+                const double ph = -2.0 * ct::kPi * k / Size;
+                t.twiddles[static_cast<std::size_t>(k)] =
+                    FftComplex{static_cast<float>(ct::cos(ph)), static_cast<float>(ct::sin(ph))};
+            }
+            int bits = 0;
+            while ((1 << bits) < kHalf) ++bits;
+            for (int i = 0; i < kHalf; i++) {
+                int r = 0;
+                for (int b = 0; b < bits; ++b)
+                    if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+                t.bitReverse[static_cast<std::size_t>(i)] = r;
+            }
+            return t;
+        }
+    };
+    static constexpr Tables kTables = Tables::make();
+
+    // Reads Size samples and writes Size / 2 + 1 bins.
+    void forward(const float* in, FftComplex* out) {
+        FftComplex* z = m_work.data();
+        for (std::size_t i = 0; i < static_cast<std::size_t>(kHalf); ++i)
+            z[kTables.bitReverse[i]] = FftComplex{in[2 * i], in[2 * i + 1]};
+
+        for (std::size_t len = 2; len <= static_cast<std::size_t>(kHalf); len <<= 1) {
+            // Twiddles of the half-size FFT are every other entry.
+            const std::size_t step = 2 * static_cast<std::size_t>(kHalf) / len;
+            const std::size_t halfLen = len / 2;
+            for (std::size_t start = 0; start < static_cast<std::size_t>(kHalf); start += len) {
+                for (std::size_t j = 0; j < halfLen; ++j) {
+                    const FftComplex w = kTables.twiddles[j * step];
+                    FftComplex& u = z[start + j];
+                    FftComplex& v = z[start + j + halfLen];
+                    const float tr = v.r * w.r - v.i * w.i;
+                    const float ti = v.r * w.i + v.i * w.r;
+                    v = FftComplex{u.r - tr, u.i - ti};
+                    u = FftComplex{u.r + tr, u.i + ti};
+                }
+            }
+        }
+
+        // X[k] = E[k] + W^k O[k] with E and O the spectra of the even and odd
+        // samples: E = (Z[k] + conj(Z[h - k])) / 2, O = (Z[k] - conj(Z[h - k])) / 2i.
+        out[0] = FftComplex{z[0].r + z[0].i, 0.0f};
+        out[kHalf] = FftComplex{z[0].r - z[0].i, 0.0f};
+        for (std::size_t k = 1; k < static_cast<std::size_t>(kHalf); ++k) {
+            const FftComplex a = z[k];
+            const FftComplex b = z[static_cast<std::size_t>(kHalf) - k];
+            const float er = 0.5f * (a.r + b.r);
+            const float ei = 0.5f * (a.i - b.i);
+            const float or_ = 0.5f * (a.i + b.i);
+            const float oi = -0.5f * (a.r - b.r);
+            const FftComplex w = kTables.twiddles[k];
+            out[k] = FftComplex{er + w.r * or_ - w.i * oi, ei + w.r * oi + w.i * or_};
+        }
+    }
+
+private:
+    alignas(64) std::array<FftComplex, kHalf> m_work{};
+};
+
+struct BinRange {
+    int low;
+    int high;
+};
+
+// Window and log-bin tables for one configuration; same formulas as
+// hannWindow() and LogBins::ranges().
+template <int SampleRate, int FftSize, int Bins>
+struct FixedTables {
+    static constexpr int kMagSize = FftSize / 2;
+
+    std::array<float, FftSize> window{};
+    std::array<BinRange, Bins> ranges{};
+    std::array<int, Bins> count{};
+    std::array<int, kMagSize> firstBand{};
+    std::array<int, kMagSize> lastBand{};
+    // Smallest distance of a band edge (in FFT bins, relative to its value)
+    // from the integer that floor/ceil would round it across. With a clear
+    // margin the ranges are the ones LogBins::ranges() computes at runtime.
+    float edgeMargin = 1.0f;
+
+    static constexpr FixedTables make() {
+        FixedTables t{};
+
+        for (int i = 0; i < FftSize; i++)
+            t.window[static_cast<std::size_t>(i)] = static_cast<float>(
+                0.5 - 0.5 * ct::cos(2.0 * ct::kPi * i / (FftSize - 1)));
+
+        const float fMin = 20.0f;
+        const float fMax = SampleRate * 0.5f;
+
+        for (int k = 0; k < kMagSize; k++) {
+            t.firstBand[static_cast<std::size_t>(k)] = 0;
+            t.lastBand[static_cast<std::size_t>(k)] = -1;
+        }
+
+        for (int i = 0; i < Bins; i++) {
+            const float a = float(i) / Bins;
+            const float b = float(i + 1) / Bins;
+
+            const float fLow  = fMin * ct::pow(fMax / fMin, a);
+            const float fHigh = fMin * ct::pow(fMax / fMin, b);
+
+            const float lowEdge = fLow * FftSize / SampleRate;
+            const float highEdge = fHigh * FftSize / SampleRate;
+            const int lowRaw = ct::floorToInt(lowEdge);
+            const int highRaw = ct::ceilToInt(highEdge);
+
+            // High edges past kMagSize - 1.5 are clamped either way.
+            t.edgeMargin = std::min(t.edgeMargin, margin(lowEdge));
+            if (highEdge < kMagSize - 1.5f) t.edgeMargin = std::min(t.edgeMargin, margin(highEdge));
+            const int low = lowRaw > 0 ? lowRaw : 0;
+            const int high = highRaw < kMagSize - 1 ? highRaw : kMagSize - 1;
+
+            t.ranges[static_cast<std::size_t>(i)] = BinRange{low, high};
+            t.count[static_cast<std::size_t>(i)] = high >= low ? high - low + 1 : 0;
+
+            for (int k = low; k <= high; k++) {
+                if (t.lastBand[static_cast<std::size_t>(k)] < 0) t.firstBand[static_cast<std::size_t>(k)] = i;
+                t.lastBand[static_cast<std::size_t>(k)] = i;
+            }
+        }
+        return t;
+    }
+
+    static constexpr float margin(float x) {
+        const float frac = x - static_cast<float>(ct::floorToInt(x));
+        return std::min(frac, 1.0f - frac) / (x > 1.0f ? x : 1.0f);
+    }
+};
+
+// Fixed-size equivalent of LogBinChain (snapshot + window, FFT,
+// magnitude + log-bin average).
+template <int SampleRate, int FftSize, int Bins>
+class FixedLogBinKernel {
+    static_assert(SampleRate > 0 && FftSize >= 4 && (FftSize & (FftSize - 1)) == 0 && Bins > 0,
+                  "invalid fixed engine configuration (FftSize must be a power of two)");
+
+public:
+    using Tables = FixedTables<SampleRate, FftSize, Bins>;
+    static constexpr Tables kTables = Tables::make();
+    static constexpr int kMagSize = Tables::kMagSize;
+
+    // ct::pow rounds a double result, so it is within about one ulp of
+    // std::pow; 1e-6 is about 8 float ulps.
+    static_assert(kTables.edgeMargin > 1e-6f,
+                  "a log-bin edge is too close to an FFT bin boundary to be sure the compile-time "
+                  "ranges match LogBins::ranges()");
+
+    void runHead(const RingView& in) {
+        const std::size_t n = std::min(static_cast<std::size_t>(FftSize), in.size);
+        const std::size_t start = (in.writeIdx + in.size - n) % in.size;
+        const std::size_t first = std::min(n, in.size - start);
+        for (std::size_t i = 0; i < first; ++i) m_block[i] = in.data[start + i] * kTables.window[i];
+        for (std::size_t i = first; i < n; ++i) m_block[i] = in.data[i - first] * kTables.window[i];
+    }
+
+    const std::array<float, Bins>& runTail() {
+        m_fft.forward(m_block.data(), m_spectrum.data());
+
+        m_bins.fill(0.0f);
+        for (std::size_t k = 0; k < static_cast<std::size_t>(kMagSize); ++k) {
+            const float r = m_spectrum[k].r;
+            const float im = m_spectrum[k].i;
+            const float mag = std::sqrt(r * r + im * im);
+            for (int b = kTables.firstBand[k]; b <= kTables.lastBand[k]; ++b)
+                m_bins[static_cast<std::size_t>(b)] += mag;
+        }
+        for (std::size_t b = 0; b < static_cast<std::size_t>(Bins); ++b) {
+            const int count = kTables.count[b];
+            m_bins[b] = (count > 0) ? m_bins[b] / count : 0.0f;
+        }
+        return m_bins;
+    }
+
+    const std::array<float, Bins>& run(const RingView& in) {
+        runHead(in);
+        return runTail();
+    }
+
+private:
+    FixedRealFft<FftSize> m_fft;
+    alignas(64) std::array<float, FftSize> m_block{};
+    alignas(64) std::array<FftComplex, FftSize / 2 + 1> m_spectrum{};
+    std::array<float, Bins> m_bins{};
+};
+
+} // namespace dsp
+
+// AudioEngine with the analysis hop specialised for one configuration.
+// Capture, FLAC recording and the public interface are shared with the
+// dynamic engine, so it can be used anywhere an AudioEngine& is expected.
+template <int SampleRate, int FftSize, int Bins>
+class FixedAudioEngine final : public AudioEngine {
+public:
+    explicit FixedAudioEngine(const std::string& flacOutputPath = "")
+        : AudioEngine(SampleRate, FftSize, Bins, flacOutputPath, CustomAnalysis{}) {}
+
+    ~FixedAudioEngine() override { stop(); }
+
+    // The configuration is part of the type.
+    bool reconfigure(int, int, int = 50) override { return false; }
+
+protected:
+    void processHop() override {
+        {
+            std::lock_guard<std::mutex> lock(captureMutex);
+            m_kernel.runHead(captureView());
+        }
+        const auto& bins = m_kernel.runTail();
+        publishLogBins(bins.data(), bins.size());
+    }
+
+private:
+    dsp::FixedLogBinKernel<SampleRate, FftSize, Bins> m_kernel;
+};
+
+// Prebuilt configurations (instantiated in FixedAudioEngine.cpp).
+extern template class FixedAudioEngine<44100, 1024, 64>;
+extern template class FixedAudioEngine<44100, 2048, 128>;
+extern template class FixedAudioEngine<44100, 4096, 128>;
+extern template class FixedAudioEngine<48000, 1024, 64>;
+extern template class FixedAudioEngine<48000, 2048, 128>;
+extern template class FixedAudioEngine<48000, 4096, 128>;
+
+using FixedAudioEngine1024x64 = FixedAudioEngine<44100, 1024, 64>;
+using FixedAudioEngine2048x128 = FixedAudioEngine<44100, 2048, 128>;
+using FixedAudioEngine4096x128 = FixedAudioEngine<44100, 4096, 128>;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Small helpers for the JSON frames sent to the Node/browser viewers.
+inline std::string jsonArray(const std::vector<float>& v) {
+    std::ostringstream oss;
+    oss << '[';
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        if (i) oss << ',';
+        oss << v[i];
+    }
+    oss << ']';
+    return oss.str();
+}
+
+inline std::string jsonString(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    out.push_back('"');
+    for (char c : s) {
+        if (c == '"' || c == '\\') out.push_back('\\');
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
+
+// Metadata message sent when a stream starts or its configuration changes.
+// sourceId is omitted when empty.
+inline std::string jsonMetadata(
+    const std::string& sourceId,
+    int sampleRate,
+    int fftSize,
+    int logBins,
+    int hopMs,
+    const std::vector<float>& centers
+) {
+    std::ostringstream oss;
+    oss << "{\"type\":\"meta\"";
+    if (!sourceId.empty()) oss << ",\"source\":" << jsonString(sourceId);
+    oss << ",\"sampleRate\":" << sampleRate
+        << ",\"fftSize\":" << fftSize
+        << ",\"logBins\":" << logBins
+        << ",\"hopMs\":" << hopMs
+        << ",\"centers\":" << jsonArray(centers)
+        << '}';
+    return oss.str();
+}
+
+// Zoom spectrum of one band: bin i is centred at startHz + i * binHz.
+inline std::string jsonZoom(
+    float lowHz,
+    float highHz,
+    float startHz,
+    float binHz,
+    const std::vector<float>& bins
+) {
+    std::ostringstream oss;
+    oss << "{\"lowHz\":" << lowHz
+        << ",\"highHz\":" << highHz
+        << ",\"startHz\":" << startHz
+        << ",\"binHz\":" << binHz
+        << ",\"bins\":" << jsonArray(bins)
+        << '}';
+    return oss.str();
+}
+
+// Field lookup for small flat control messages from clients, e.g.
+// {"type":"zoom","lowHz":50,"highHz":70}. Not a general JSON parser: nested
+// objects and escaped quotes are not handled.
+inline std::size_t jsonFieldValue(const std::string& json, const std::string& key) {
+    const std::string quoted = "\"" + key + "\"";
+    std::size_t pos = json.find(quoted);
+    if (pos == std::string::npos) return pos;
+    pos = json.find_first_not_of(" \t\r\n", pos + quoted.size());
+    if (pos == std::string::npos || json[pos] != ':') return std::string::npos;
+    return json.find_first_not_of(" \t\r\n", pos + 1);
+}
+
+inline bool jsonNumberField(const std::string& json, const std::string& key, double& out) {
+    const std::size_t pos = jsonFieldValue(json, key);
+    if (pos == std::string::npos) return false;
+    const char* begin = json.c_str() + pos;
+    char* end = nullptr;
+    const double v = std::strtod(begin, &end);
+    if (end == begin) return false;
+    out = v;
+    return true;
+}
+
+inline bool jsonStringField(const std::string& json, const std::string& key, std::string& out) {
+    const std::size_t pos = jsonFieldValue(json, key);
+    if (pos == std::string::npos || json[pos] != '"') return false;
+    const std::size_t end = json.find('"', pos + 1);
+    if (end == std::string::npos) return false;
+    out = json.substr(pos + 1, end - pos - 1);
+    return true;
+}
@@ -3,16 +3,20 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <utility>
 
 class LogBins {
 public:
-    static std::vector<float> compute(
-        const std::vector<float>& fftMag,
+    // Inclusive FFT-bin index range [low, high] averaged into each log bin.
+    // magSize is the number of magnitude values available (usually fftSize / 2).
+    static std::vector<std::pair<int, int>> ranges(
         int sampleRate,
         int fftSize,
-        int numBins
+        int numBins,
+        int magSize
     ) {
-        std::vector<float> out(numBins, 0.0f);
+        std::vector<std::pair<int, int>> out;
+        out.reserve(static_cast<std::size_t>(std::max(0, numBins)));
 
         float fMin = 20.0f;
         float fMax = sampleRate * 0.5f;
@@ -28,14 +32,52 @@ public:
                 0, int(std::floor(fLow * fftSize / sampleRate))
             );
             int binHigh = std::min(
-                int(fftMag.size()) - 1,
+                magSize - 1,
                 int(std::ceil(fHigh * fftSize / sampleRate))
             );
 
+            out.emplace_back(binLow, binHigh);
+        }
+
+        return out;
+    }
+
+    // Center frequency (geometric mean of the band edges) of each log bin,
+    // as AudioEngine reports them.
+    static std::vector<float> centers(int sampleRate, int numBins) {
+        std::vector<float> out;
+        out.reserve(static_cast<std::size_t>(std::max(0, numBins)));
+
+        const float fMin = 20.0f;
+        const float fMax = static_cast<float>(sampleRate) * 0.5f;
+
+        for (int i = 0; i < numBins; i++) {
+            const float a = static_cast<float>(i) / static_cast<float>(numBins);
+            const float b = static_cast<float>(i + 1) / static_cast<float>(numBins);
+
+            const float fLow  = fMin * std::pow(fMax / fMin, a);
+            const float fHigh = fMin * std::pow(fMax / fMin, b);
+
+            out.push_back(std::sqrt(fLow * fHigh));
+        }
+        return out;
+    }
+
+    static std::vector<float> compute(
+        const std::vector<float>& fftMag,
+        int sampleRate,
+        int fftSize,
+        int numBins
+    ) {
+        std::vector<float> out(numBins, 0.0f);
+
+        const auto r = ranges(sampleRate, fftSize, numBins, int(fftMag.size()));
+
+        for (int i = 0; i < numBins; i++) {
             float sum = 0.0f;
             int count = 0;
 
-            for (int b = binLow; b <= binHigh; b++) {
+            for (int b = r[i].first; b <= r[i].second; b++) {
                 sum += fftMag[b];
                 count++;
             }
@@ -46,4 +88,3 @@ public:
         return out;
     }
 };
-
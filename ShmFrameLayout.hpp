@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Binary layout of the shared-memory frame ring (see ShmFrameRing /
+// ShmFrameReader). Everything is native-endian and fixed-size so co-located
+// consumers can map it read-only and use the frames in place.
+//
+//   [ShmRingHeader][centers: float x binCount][pad to 64]
+//   [slot 0][slot 1]...[slot slotCount-1]
+//
+//   slot = [ShmSlotHeader][bins: float x binCount][pad to 64]
+//
+// Each slot is guarded by its own seqlock: the writer makes `seqlock` odd,
+// writes the record, then makes it even again. Frame n lives in slot
+// n % slotCount.
+namespace shm_layout {
+
+constexpr std::uint32_t kMagic = 0x52464541u; // "AEFR"
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kAlign = 64;
+constexpr std::uint64_t kEmptySlot = ~std::uint64_t(0);
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+struct ShmRingHeader {
+    std::atomic<std::uint32_t> magic;   // written last by the producer
+    std::uint32_t version;
+    std::uint32_t slotCount;
+    std::uint32_t binCount;
+    std::uint32_t sampleRate;
+    std::uint32_t fftSize;
+    std::uint64_t slotStride;           // bytes per slot
+    std::uint64_t slotsOffset;          // offset of slot 0 from the header
+    std::atomic<std::uint64_t> published; // frames published so far
+    std::atomic<std::uint32_t> retired; // 1: producer replaced or closed this ring
+    std::uint32_t reserved;
+};
+
+struct ShmSlotHeader {
+    std::atomic<std::uint64_t> seqlock;
+    std::uint64_t frameSeq;             // kEmptySlot until first written
+    std::int64_t timestampNs;           // steady_clock, producer's epoch
+    std::uint32_t binCount;
+    std::uint32_t reserved;
+};
+
+constexpr std::size_t alignUp(std::size_t n) { return (n + kAlign - 1) / kAlign * kAlign; }
+
+constexpr std::size_t slotsOffset(std::uint32_t binCount) {
+    return alignUp(sizeof(ShmRingHeader) + sizeof(float) * binCount);
+}
+
+constexpr std::size_t slotStride(std::uint32_t binCount) {
+    return alignUp(sizeof(ShmSlotHeader) + sizeof(float) * binCount);
+}
+
+constexpr std::size_t totalSize(std::uint32_t slotCount, std::uint32_t binCount) {
+    return slotsOffset(binCount) + slotStride(binCount) * slotCount;
+}
+
+} // namespace shm_layout
@@ -0,0 +1,74 @@
+#include "ShmFrameReader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace shm_layout;
+
+ShmFrameReader::~ShmFrameReader() { close(); }
+
+bool ShmFrameReader::open(const std::string& name, std::string* error) {
+    close();
+
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        if (error) *error = "shm_open " + name + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(ShmRingHeader)) {
+        if (error) *error = "segment " + name + " is not initialised yet";
+        ::close(fd);
+        return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* mem = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        if (error) *error = "mmap " + name + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const auto* h = static_cast<const ShmRingHeader*>(mem);
+    const bool valid =
+        h->magic.load(std::memory_order_acquire) == kMagic &&
+        h->version == kVersion &&
+        h->slotCount > 0 &&
+        totalSize(h->slotCount, h->binCount) <= size;
+    if (!valid) {
+        if (error) *error = "segment " + name + " is not a frame ring (or not ready yet)";
+        ::munmap(mem, size);
+        return false;
+    }
+
+    m_base = static_cast<const unsigned char*>(mem);
+    m_size = size;
+    return true;
+}
+
+void ShmFrameReader::close() {
+    if (!m_base) return;
+    ::munmap(const_cast<unsigned char*>(m_base), m_size);
+    m_base = nullptr;
+    m_size = 0;
+}
+
+ShmFrameReader::ReadStatus ShmFrameReader::copy(
+    std::uint64_t seq, std::vector<float>& out, std::int64_t* timestampNs) const {
+    out.resize(binCount());
+    std::int64_t ts = 0;
+    const auto st = read(seq, [&](const FrameView& f) {
+        std::memcpy(out.data(), f.bins, sizeof(float) * std::min<std::size_t>(out.size(), f.binCount));
+        ts = f.timestampNs;
+    });
+    if (st == ReadStatus::Ok && timestampNs) *timestampNs = ts;
+    return st;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ShmFrameLayout.hpp"
+
+// Consumer side of the shared-memory frame ring. Maps the segment read-only;
+// frames are read in place (no copies) under the slot's seqlock.
+//
+//   ShmFrameReader r;
+//   if (!r.open("/audioengine")) ...;
+//   std::uint64_t next = r.published();
+//   for (;;) {
+//     auto st = r.read(next, [&](const ShmFrameReader::FrameView& f) { ... });
+//     if (st == ShmFrameReader::ReadStatus::Ok) ++next;
+//     else if (st == ShmFrameReader::ReadStatus::Overwritten) next = r.oldestAvailable();
+//     else if (r.retired()) r.open("/audioengine"); // producer reconfigured
+//   }
+//
+// Anything derived from a FrameView must be discarded unless read() returns
+// Ok: the producer may have overwritten the slot while the callback ran.
+class ShmFrameReader final {
+public:
+    struct FrameView {
+        std::uint64_t seq;
+        std::int64_t timestampNs;
+        const float* bins;
+        std::uint32_t binCount;
+    };
+
+    enum class ReadStatus {
+        Ok,
+        NotYetWritten, // seq has not been published yet
+        Overwritten,   // the slot already holds a newer frame
+        Torn,          // the producer was writing the slot; retry
+        Closed,
+    };
+
+    ShmFrameReader() = default;
+    ~ShmFrameReader();
+
+    ShmFrameReader(const ShmFrameReader&) = delete;
+    ShmFrameReader& operator=(const ShmFrameReader&) = delete;
+
+    bool open(const std::string& name, std::string* error = nullptr);
+    void close();
+
+    bool isOpen() const noexcept { return m_base != nullptr; }
+
+    // True once the producer closed or replaced the ring (e.g. after a
+    // reconfiguration); reopen by name to follow it.
+    bool retired() const noexcept {
+        return !m_base || header()->retired.load(std::memory_order_acquire) != 0;
+    }
+
+    std::uint32_t binCount() const noexcept { return m_base ? header()->binCount : 0; }
+    std::uint32_t slotCount() const noexcept { return m_base ? header()->slotCount : 0; }
+    int sampleRate() const noexcept { return m_base ? static_cast<int>(header()->sampleRate) : 0; }
+    int fftSize() const noexcept { return m_base ? static_cast<int>(header()->fftSize) : 0; }
+
+    // Bin center frequencies, binCount() entries, in place.
+    const float* centers() const noexcept {
+        return m_base ? reinterpret_cast<const float*>(m_base + sizeof(shm_layout::ShmRingHeader)) : nullptr;
+    }
+
+    // Number of frames published so far; the newest frame is published() - 1.
+    std::uint64_t published() const noexcept {
+        return m_base ? header()->published.load(std::memory_order_acquire) : 0;
+    }
+
+    std::uint64_t oldestAvailable() const noexcept {
+        const std::uint64_t p = published();
+        const std::uint64_t n = slotCount();
+        return p > n ? p - n : 0;
+    }
+
+    template <typename Fn>
+    ReadStatus read(std::uint64_t seq, Fn&& fn) const {
+        if (!m_base) return ReadStatus::Closed;
+        const auto* h = header();
+        const unsigned char* slotBase = m_base + h->slotsOffset + h->slotStride * (seq % h->slotCount);
+        const auto* slot = reinterpret_cast<const shm_layout::ShmSlotHeader*>(slotBase);
+
+        const std::uint64_t before = slot->seqlock.load(std::memory_order_acquire);
+        if (before & 1u) return ReadStatus::Torn;
+
+        const std::uint64_t frameSeq = slot->frameSeq;
+        if (frameSeq != seq) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->seqlock.load(std::memory_order_relaxed) != before) return ReadStatus::Torn;
+            return (frameSeq == shm_layout::kEmptySlot || frameSeq < seq)
+                ? ReadStatus::NotYetWritten
+                : ReadStatus::Overwritten;
+        }
+
+        fn(FrameView{
+            frameSeq,
+            slot->timestampNs,
+            reinterpret_cast<const float*>(slotBase + sizeof(shm_layout::ShmSlotHeader)),
+            slot->binCount
+        });
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seqlock.load(std::memory_order_relaxed) != before) return ReadStatus::Torn;
+        return ReadStatus::Ok;
+    }
+
+    // Convenience: copies frame seq into out (resized to binCount()).
+    ReadStatus copy(std::uint64_t seq, std::vector<float>& out, std::int64_t* timestampNs = nullptr) const;
+
+private:
+    const shm_layout::ShmRingHeader* header() const noexcept {
+        return reinterpret_cast<const shm_layout::ShmRingHeader*>(m_base);
+    }
+
+    const unsigned char* m_base{nullptr};
+    std::size_t m_size{0};
+};
@@ -0,0 +1,129 @@
+#include "ShmFrameRing.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace shm_layout;
+
+namespace {
+void setError(std::string* error, const std::string& what) {
+    if (error) *error = what + ": " + std::strerror(errno);
+}
+} // namespace
+
+ShmFrameRing::~ShmFrameRing() { close(); }
+
+bool ShmFrameRing::create(
+    const std::string& name,
+    std::uint32_t slotCount,
+    int sampleRate,
+    int fftSize,
+    const std::vector<float>& centers,
+    std::string* error
+) {
+    close();
+    if (slotCount == 0 || centers.empty()) {
+        if (error) *error = "slot and bin counts must be non-zero";
+        return false;
+    }
+
+    const std::uint32_t binCount = static_cast<std::uint32_t>(centers.size());
+    const std::size_t size = totalSize(slotCount, binCount);
+
+    // Unlink first: readers of an old segment keep their mapping intact.
+    ::shm_unlink(name.c_str());
+    const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        setError(error, "shm_open " + name);
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        setError(error, "ftruncate " + name);
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    void* mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        setError(error, "mmap " + name);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+
+    m_name = name;
+    m_base = static_cast<unsigned char*>(mem);
+    m_size = size;
+    m_slotCount = slotCount;
+    m_binCount = binCount;
+    m_next = 0;
+
+    auto* header = new (m_base) ShmRingHeader{};
+    header->version = kVersion;
+    header->slotCount = slotCount;
+    header->binCount = binCount;
+    header->sampleRate = static_cast<std::uint32_t>(sampleRate);
+    header->fftSize = static_cast<std::uint32_t>(fftSize);
+    header->slotStride = slotStride(binCount);
+    header->slotsOffset = slotsOffset(binCount);
+    header->published.store(0, std::memory_order_relaxed);
+    header->retired.store(0, std::memory_order_relaxed);
+    std::memcpy(m_base + sizeof(ShmRingHeader), centers.data(), sizeof(float) * binCount);
+
+    for (std::uint32_t i = 0; i < slotCount; ++i) {
+        auto* slot = new (m_base + header->slotsOffset + header->slotStride * i) ShmSlotHeader{};
+        slot->seqlock.store(0, std::memory_order_relaxed);
+        slot->frameSeq = kEmptySlot;
+        slot->binCount = binCount;
+    }
+
+    // Readers only trust the layout once the magic is visible.
+    header->magic.store(kMagic, std::memory_order_release);
+    return true;
+}
+
+void ShmFrameRing::close() {
+    if (!m_base) return;
+    auto* header = reinterpret_cast<ShmRingHeader*>(m_base);
+    header->retired.store(1, std::memory_order_release);
+    ::munmap(m_base, m_size);
+    if (!m_name.empty()) ::shm_unlink(m_name.c_str());
+    m_base = nullptr;
+    m_size = 0;
+}
+
+void ShmFrameRing::retire() noexcept {
+    if (!m_base) return;
+    reinterpret_cast<ShmRingHeader*>(m_base)->retired.store(1, std::memory_order_release);
+    m_name.clear();
+}
+
+void ShmFrameRing::publish(const float* bins, std::size_t count, std::int64_t timestampNs) {
+    if (!m_base) return;
+    auto* header = reinterpret_cast<ShmRingHeader*>(m_base);
+
+    const std::uint64_t seq = m_next++;
+    unsigned char* slotBase = m_base + header->slotsOffset + header->slotStride * (seq % m_slotCount);
+    auto* slot = reinterpret_cast<ShmSlotHeader*>(slotBase);
+    float* data = reinterpret_cast<float*>(slotBase + sizeof(ShmSlotHeader));
+
+    const std::uint64_t lock = slot->seqlock.load(std::memory_order_relaxed);
+    slot->seqlock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->frameSeq = seq;
+    slot->timestampNs = timestampNs;
+    const std::size_t n = std::min<std::size_t>(count, m_binCount);
+    std::memcpy(data, bins, sizeof(float) * n);
+    if (n < m_binCount) std::memset(data + n, 0, sizeof(float) * (m_binCount - n));
+
+    slot->seqlock.store(lock + 2, std::memory_order_release);
+    header->published.store(seq + 1, std::memory_order_release);
+}
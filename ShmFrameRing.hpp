@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ShmFrameLayout.hpp"
+
+// Producer side of the shared-memory frame ring (POSIX shm, i.e. /dev/shm).
+// Creates the named segment, writes the metadata header (including the bin
+// centers) and publishes one fixed-size binary record per frame. Never blocks
+// on readers: slow readers see their frames overwritten.
+class ShmFrameRing final {
+public:
+    ShmFrameRing() = default;
+    ~ShmFrameRing();
+
+    ShmFrameRing(const ShmFrameRing&) = delete;
+    ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+    // name is a POSIX shm name such as "/audioengine". An existing segment of
+    // that name is replaced.
+    bool create(
+        const std::string& name,
+        std::uint32_t slotCount,
+        int sampleRate,
+        int fftSize,
+        const std::vector<float>& centers,
+        std::string* error = nullptr
+    );
+
+    // Marks the ring retired (readers should reopen), unmaps and unlinks it.
+    void close();
+
+    // Marks the ring retired but keeps it mapped, for when a replacement
+    // ring has already been created under the same name; close() then no
+    // longer unlinks that name.
+    void retire() noexcept;
+
+    bool isOpen() const noexcept { return m_base != nullptr; }
+    std::uint32_t binCount() const noexcept { return m_binCount; }
+
+    // count must equal binCount(); extra values are ignored, missing ones zeroed.
+    void publish(const float* bins, std::size_t count, std::int64_t timestampNs);
+
+private:
+    std::string m_name;
+    unsigned char* m_base{nullptr};
+    std::size_t m_size{0};
+    std::uint32_t m_slotCount{0};
+    std::uint32_t m_binCount{0};
+    std::uint64_t m_next{0};
+};
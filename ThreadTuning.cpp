@@ -0,0 +1,112 @@
+#include "ThreadTuning.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace thread_tuning {
+
+namespace {
+void setError(std::string* error, const std::string& what) {
+    if (error) {
+        if (!error->empty()) *error += "; ";
+        *error += what;
+    }
+}
+} // namespace
+
+bool applyToCurrentThread(const ThreadPolicy& policy, std::string* error) {
+    if (policy.isDefault()) return true;
+#if defined(__linux__)
+    bool ok = true;
+
+    if (!policy.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : policy.cpus)
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            setError(error, std::string("CPU affinity: ") + std::strerror(rc));
+            ok = false;
+        }
+    }
+
+    if (policy.scheduling != ThreadPolicy::Scheduling::Default) {
+        const int cls = policy.scheduling == ThreadPolicy::Scheduling::Fifo ? SCHED_FIFO : SCHED_RR;
+        sched_param param{};
+        param.sched_priority = std::clamp(
+            policy.priority, sched_get_priority_min(cls), sched_get_priority_max(cls));
+        const int rc = pthread_setschedparam(pthread_self(), cls, &param);
+        if (rc != 0) {
+            setError(error, std::string("real-time scheduling: ") + std::strerror(rc));
+            ok = false;
+        }
+    }
+    return ok;
+#else
+    setError(error, "thread tuning not supported on this platform");
+    return false;
+#endif
+}
+
+bool lockProcessMemory(std::string* error) {
+#if defined(__linux__)
+    if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        setError(error, std::string("mlockall: ") + std::strerror(errno));
+        return false;
+    }
+    return true;
+#else
+    setError(error, "mlockall not supported on this platform");
+    return false;
+#endif
+}
+
+void unlockProcessMemory() {
+#if defined(__linux__)
+    ::munlockall();
+#endif
+}
+
+void prefault(void* data, std::size_t bytes) {
+    if (!data || bytes == 0) return;
+#if defined(__linux__)
+    const long page = ::sysconf(_SC_PAGESIZE);
+    const std::size_t step = page > 0 ? static_cast<std::size_t>(page) : 4096;
+#else
+    const std::size_t step = 4096;
+#endif
+    volatile unsigned char* p = static_cast<volatile unsigned char*>(data);
+    for (std::size_t off = 0; off < bytes; off += step) p[off] = p[off];
+    p[bytes - 1] = p[bytes - 1];
+}
+
+namespace {
+constexpr std::size_t kStackChunk = 4096;
+
+// One 4 KB frame per level. The volatile writes cannot be dropped, and
+// reading the frame after the recursive call keeps the call out of tail
+// position, so every level really occupies its own stack; noinline keeps the
+// levels from being merged into one frame.
+[[gnu::noinline]] unsigned touchStack(std::size_t bytes) {
+    volatile unsigned char chunk[kStackChunk];
+    for (std::size_t i = 0; i < kStackChunk; i += 64) chunk[i] = 0;
+    const unsigned below = bytes > kStackChunk ? touchStack(bytes - kStackChunk) : 0u;
+    return below + chunk[0] + chunk[kStackChunk - 64];
+}
+} // namespace
+
+void prefaultStack(std::size_t bytes) {
+    volatile unsigned sink = touchStack(bytes);
+    (void)sink;
+}
+
+} // namespace thread_tuning
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Scheduling class, priority and CPU affinity for one of the engine's threads.
+// Default-constructed policies leave the thread untouched.
+struct ThreadPolicy {
+    enum class Scheduling { Default, Fifo, RoundRobin };
+
+    Scheduling scheduling = Scheduling::Default;
+    int priority = 0;      // 1..99 for Fifo / RoundRobin (clamped)
+    std::vector<int> cpus; // empty: no pinning
+
+    bool isDefault() const { return scheduling == Scheduling::Default && cpus.empty(); }
+};
+
+// Best-effort helpers. Real-time priorities and mlockall usually need
+// CAP_SYS_NICE / CAP_IPC_LOCK (or matching rlimits); when not permitted they
+// return false and describe why in *error, and the caller carries on.
+namespace thread_tuning {
+
+bool applyToCurrentThread(const ThreadPolicy& policy, std::string* error = nullptr);
+
+// mlockall(MCL_CURRENT | MCL_FUTURE): process-wide and permanent until
+// unlockProcessMemory(), so it is an opt-in for a dedicated process.
+bool lockProcessMemory(std::string* error = nullptr);
+
+// munlockall().
+void unlockProcessMemory();
+
+// Touches every page of [data, data + bytes) so it is resident before use.
+void prefault(void* data, std::size_t bytes);
+
+// Touches the next `bytes` of the calling thread's stack.
+void prefaultStack(std::size_t bytes = 64 * 1024);
+
+} // namespace thread_tuning
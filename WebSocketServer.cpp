@@ -1,15 +1,26 @@
 #include "WebSocketServer.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <sstream>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
 namespace {
 
 std::string trim(const std::string& s) {
@@ -20,7 +31,15 @@ std::string trim(const std::string& s) {
   return s.substr(a, b - a);
 }
 
-// Very small HTTP header parser: returns value for a key (case-sensitive).
+bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+// Very small HTTP header parser: returns value for a key (field names are
+// case-insensitive).
 std::string headerValue(const std::string& headers, const std::string& key) {
   std::istringstream iss(headers);
   std::string line;
@@ -29,44 +48,263 @@ std::string headerValue(const std::string& headers, const std::string& key) {
     auto pos = line.find(':');
     if (pos == std::string::npos) continue;
     const std::string k = line.substr(0, pos);
-    if (k == key) return trim(line.substr(pos + 1));
+    if (equalsIgnoreCase(k, key)) return trim(line.substr(pos + 1));
   }
   return {};
 }
 
+// Comma-separated header list items, trimmed.
+std::vector<std::string> headerList(const std::string& value) {
+  std::vector<std::string> out;
+  std::size_t start = 0;
+  while (start <= value.size()) {
+    const std::size_t end = std::min(value.find(',', start), value.size());
+    const std::string item = trim(value.substr(start, end - start));
+    if (!item.empty()) out.push_back(item);
+    start = end + 1;
+  }
+  return out;
+}
+
+// True if Accept-Encoding lists coding without q=0.
+bool acceptsEncoding(const std::string& acceptEncoding, const std::string& coding) {
+  for (const auto& item : headerList(acceptEncoding)) {
+    const std::size_t semi = item.find(';');
+    if (!equalsIgnoreCase(trim(item.substr(0, semi)), coding)) continue;
+    if (semi == std::string::npos) return true;
+    const std::size_t q = item.find("q=", semi);
+    return q == std::string::npos || std::strtod(item.c_str() + q + 2, nullptr) > 0.0;
+  }
+  return false;
+}
+
+// Percent-decodes a URL path; false for malformed escapes or NUL bytes.
+bool decodePath(const std::string& in, std::string& out) {
+  out.clear();
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    if (in[i] != '%') {
+      out.push_back(in[i]);
+      continue;
+    }
+    if (i + 2 >= in.size() || !std::isxdigit(static_cast<unsigned char>(in[i + 1])) ||
+        !std::isxdigit(static_cast<unsigned char>(in[i + 2])))
+      return false;
+    const char c = static_cast<char>(std::strtol(in.substr(i + 1, 2).c_str(), nullptr, 16));
+    if (c == '\0') return false;
+    out.push_back(c);
+    i += 2;
+  }
+  return true;
+}
+
+bool setNonBlocking(int fd) {
+  const int flags = ::fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// True if the query string of target has name=value among its parameters.
+bool hasQueryValue(const std::string& target, const std::string& name, const std::string& value) {
+  const std::size_t q = target.find('?');
+  if (q == std::string::npos) return false;
+  const std::string wanted = name + "=" + value;
+  std::size_t begin = q + 1;
+  while (begin <= target.size()) {
+    std::size_t end = target.find('&', begin);
+    if (end == std::string::npos) end = target.size();
+    if (target.compare(begin, end - begin, wanted) == 0) return true;
+    begin = end + 1;
+  }
+  return false;
+}
+
+const char* contentType(const std::string& path) {
+  static const std::pair<const char*, const char*> kTypes[] = {
+      {".html", "text/html; charset=utf-8"},
+      {".htm", "text/html; charset=utf-8"},
+      {".js", "text/javascript; charset=utf-8"},
+      {".mjs", "text/javascript; charset=utf-8"},
+      {".css", "text/css; charset=utf-8"},
+      {".json", "application/json"},
+      {".map", "application/json"},
+      {".txt", "text/plain; charset=utf-8"},
+      {".svg", "image/svg+xml"},
+      {".png", "image/png"},
+      {".jpg", "image/jpeg"},
+      {".jpeg", "image/jpeg"},
+      {".ico", "image/x-icon"},
+      {".wasm", "application/wasm"},
+  };
+  const std::size_t dot = path.rfind('.');
+  if (dot != std::string::npos && path.find('/', dot) == std::string::npos) {
+    const std::string ext = path.substr(dot);
+    for (const auto& t : kTypes)
+      if (equalsIgnoreCase(ext, t.first)) return t.second;
+  }
+  return "application/octet-stream";
+}
+
+// Strong validator from size and modification time (plus the variant served).
+std::string makeETag(const struct stat& st, const char* variant) {
+#if defined(__linux__)
+  const auto seconds = static_cast<unsigned long long>(st.st_mtim.tv_sec);
+  const auto nanoseconds = static_cast<unsigned long long>(st.st_mtim.tv_nsec);
+#else
+  // POSIX only guarantees whole seconds.
+  const auto seconds = static_cast<unsigned long long>(st.st_mtime);
+  const unsigned long long nanoseconds = 0;
+#endif
+  std::ostringstream oss;
+  oss << '"' << std::hex << static_cast<unsigned long long>(st.st_size) << '-' << seconds << '.' << nanoseconds
+      << variant << '"';
+  return oss.str();
+}
+
+bool etagMatches(const std::string& ifNoneMatch, const std::string& etag) {
+  for (auto item : headerList(ifNoneMatch)) {
+    if (item == "*") return true;
+    if (item.compare(0, 2, "W/") == 0) item.erase(0, 2);
+    if (item == etag) return true;
+  }
+  return false;
+}
+
+// Reassembles the (masked) frames one client sends.
+struct IncomingMessages {
+  std::string buffer;  // bytes not yet parsed
+  std::string message; // text fragments received so far
+  bool inText = false;
+};
+
 } // namespace
 
-WebSocketServer::WebSocketServer(int port) : m_port(port) {}
+WebSocketServer::Client::~Client() { ::close(fd); }
 
-WebSocketServer::~WebSocketServer() { stop(); }
+WebSocketServer::WebSocketServer(int port) : m_port(port) {
+  // Without the pipe new connections are still picked up, only up to one
+  // poll interval later.
+  if (::pipe(m_httpWake) != 0 || !setNonBlocking(m_httpWake[0]) || !setNonBlocking(m_httpWake[1])) {
+    closeFd_(m_httpWake[0]);
+    closeFd_(m_httpWake[1]);
+  }
+}
+
+WebSocketServer::~WebSocketServer() {
+  stop();
+  closeFd_(m_httpWake[0]);
+  closeFd_(m_httpWake[1]);
+}
 
 void WebSocketServer::start(PayloadProvider provider, int intervalMs) {
   if (m_running.load()) return;
   m_provider = std::move(provider);
   m_intervalMs = std::max(10, intervalMs);
+  m_pushMode = false;
+  m_stopRequested = false;
+  m_running = true;
+
+  m_acceptThread = std::thread(&WebSocketServer::acceptLoop_, this);
+  m_broadcastThread = std::thread(&WebSocketServer::broadcastLoop_, this);
+  m_receiveThread = std::thread(&WebSocketServer::receiveLoop_, this);
+  m_httpThread = std::thread(&WebSocketServer::httpLoop_, this);
+}
+
+void WebSocketServer::start() {
+  if (m_running.load()) return;
+  m_provider = nullptr;
+  m_pushMode = true;
   m_stopRequested = false;
   m_running = true;
 
   m_acceptThread = std::thread(&WebSocketServer::acceptLoop_, this);
   m_broadcastThread = std::thread(&WebSocketServer::broadcastLoop_, this);
+  m_receiveThread = std::thread(&WebSocketServer::receiveLoop_, this);
+  m_httpThread = std::thread(&WebSocketServer::httpLoop_, this);
+}
+
+void WebSocketServer::broadcast(std::string text) {
+  {
+    std::lock_guard<std::mutex> lk(m_queueMutex);
+    m_queue.push_back(OutgoingFrame{std::move(text), false});
+    while (m_queue.size() > kMaxQueuedFrames) m_queue.pop_front();
+  }
+  m_queueCv.notify_one();
+}
+
+void WebSocketServer::setBinaryProvider(PayloadProvider provider) { m_binaryProvider = std::move(provider); }
+
+void WebSocketServer::broadcastBinary(std::string data) {
+  {
+    std::lock_guard<std::mutex> lk(m_queueMutex);
+    m_queue.push_back(OutgoingFrame{std::move(data), true});
+    while (m_queue.size() > kMaxQueuedFrames) m_queue.pop_front();
+  }
+  m_queueCv.notify_one();
+}
+
+void WebSocketServer::setMessageHandler(MessageHandler handler) { m_messageHandler = std::move(handler); }
+
+bool WebSocketServer::setStaticRoot(const std::string& directory, std::string* error) {
+  char resolved[PATH_MAX];
+  struct stat st {};
+  if (!::realpath(directory.c_str(), resolved) || ::stat(resolved, &st) != 0 || !S_ISDIR(st.st_mode)) {
+    if (error) *error = "not a directory: " + directory;
+    return false;
+  }
+  m_staticRoot = resolved;
+  return true;
+}
+
+std::size_t WebSocketServer::clientCount() {
+  std::lock_guard<std::mutex> lk(m_clientsMutex);
+  return m_clients.size();
+}
+
+void WebSocketServer::setThreadPolicy(const ThreadPolicy& policy) { m_threadPolicy = policy; }
+
+std::string WebSocketServer::threadPolicyError() {
+  std::lock_guard<std::mutex> lk(m_policyErrorMutex);
+  return m_policyError;
+}
+
+void WebSocketServer::applyThreadPolicy_() {
+  std::string error;
+  if (thread_tuning::applyToCurrentThread(m_threadPolicy, &error)) return;
+  std::lock_guard<std::mutex> lk(m_policyErrorMutex);
+  m_policyError = error;
 }
 
 void WebSocketServer::stop() {
   if (!m_running.exchange(false)) return;
-  m_stopRequested = true;
+  {
+    std::lock_guard<std::mutex> lk(m_queueMutex);
+    m_stopRequested = true;
+  }
+  m_queueCv.notify_all();
 
   // Closing the listen FD breaks accept().
   closeFd_(m_listenFd);
+  const char wake = 1;
+  (void)!::write(m_httpWake[1], &wake, 1);
 
   if (m_acceptThread.joinable()) m_acceptThread.join();
   if (m_broadcastThread.joinable()) m_broadcastThread.join();
+  if (m_receiveThread.joinable()) m_receiveThread.join();
+  if (m_httpThread.joinable()) m_httpThread.join();
 
+  {
+    std::lock_guard<std::mutex> lk(m_httpMutex);
+    for (auto& c : m_httpPending) closeFd_(c.fd);
+    m_httpPending.clear();
+  }
+
+  // The threads are gone, so these are the last references.
   std::lock_guard<std::mutex> lk(m_clientsMutex);
-  for (int& fd : m_clients) closeFd_(fd);
   m_clients.clear();
 }
 
 void WebSocketServer::acceptLoop_() {
+  applyThreadPolicy_();
+
   m_listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
   if (m_listenFd < 0) return;
 
@@ -82,7 +320,7 @@ void WebSocketServer::acceptLoop_() {
     closeFd_(m_listenFd);
     return;
   }
-  if (::listen(m_listenFd, 16) != 0) {
+  if (::listen(m_listenFd, SOMAXCONN) != 0) {
     closeFd_(m_listenFd);
     return;
   }
@@ -94,105 +332,562 @@ void WebSocketServer::acceptLoop_() {
       continue;
     }
 
-    // Read HTTP request (best-effort, capped).
-    std::string req;
-    req.resize(8192);
-    const ssize_t n = ::recv(client, req.data(), req.size(), 0);
-    if (n <= 0) {
+    // The request is read by the HTTP thread, so a client that never sends
+    // one cannot stall the accept thread.
+    if (!setNonBlocking(client)) {
       closeFd_(client);
       continue;
     }
-    req.resize(static_cast<std::size_t>(n));
 
-    const auto key = headerValue(req, "Sec-WebSocket-Key");
-    if (key.empty()) {
-      closeFd_(client);
-      continue;
+    {
+      std::lock_guard<std::mutex> lk(m_httpMutex);
+      m_httpPending.push_back(HttpConnection{client, {}});
     }
+    const char wake = 1;
+    (void)!::write(m_httpWake[1], &wake, 1);
+  }
+}
 
-    const std::string acceptKey = makeAcceptKey_(key);
-    const std::string resp =
-        "HTTP/1.1 101 Switching Protocols\r\n"
-        "Upgrade: websocket\r\n"
-        "Connection: Upgrade\r\n"
-        "Sec-WebSocket-Accept: " + acceptKey + "\r\n"
-        "\r\n";
+WebSocketServer::HttpReply WebSocketServer::upgradeReply_(const std::string& head) {
+  std::istringstream line(head.substr(0, head.find("\r\n")));
+  std::string method, target;
+  line >> method >> target;
+
+  HttpReply reply;
+  reply.upgrade = true;
+  reply.binary = hasQueryValue(target, "format", "binary");
+  reply.head =
+      "HTTP/1.1 101 Switching Protocols\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: Upgrade\r\n"
+      "Sec-WebSocket-Accept: " + makeAcceptKey(headerValue(head, "Sec-WebSocket-Key")) + "\r\n"
+      "\r\n";
+  return reply;
+}
 
-    if (!sendAll_(client, resp.data(), resp.size())) {
-      closeFd_(client);
-      continue;
-    }
+bool WebSocketServer::addClient_(int fd, bool binary, std::string leftover) {
+  // Frames are queued per client and written without blocking.
+  if (!setNonBlocking(fd)) return false;
+  const int sendBuffer = kClientSendBufferBytes;
+  (void)::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+
+  std::lock_guard<std::mutex> lk(m_clientsMutex);
+  auto client = std::make_shared<Client>(fd, m_nextClientId++, binary);
+  client->initialInput = std::move(leftover);
+  m_clients.push_back(std::move(client));
+  return true;
+}
 
+void WebSocketServer::httpLoop_() {
+  applyThreadPolicy_();
+
+  // Every connection is non-blocking, read and written as far as its socket
+  // allows, so a slow client only ever delays itself. Requests on one
+  // connection are answered in order; after a 101 reply the socket moves to
+  // the WebSocket clients.
+  struct Connection {
+    HttpConnection http;
+    std::chrono::steady_clock::time_point lastActive;
+    HttpReply reply;
+    std::size_t headSent = 0;
+    off_t bodySent = 0;
+    bool replying = false;
+  };
+  auto finishReply = [](Connection& c) {
+    if (c.reply.fileFd >= 0) ::close(c.reply.fileFd);
+    c.reply = HttpReply{};
+    c.replying = false;
+  };
+
+  std::vector<Connection> conns;
+  std::vector<pollfd> fds;
+  char buf[4096];
+
+  while (m_running.load() && !m_stopRequested.load()) {
+    const auto now = std::chrono::steady_clock::now();
     {
-      std::lock_guard<std::mutex> lk(m_clientsMutex);
-      m_clients.push_back(client);
+      std::lock_guard<std::mutex> lk(m_httpMutex);
+      for (auto& p : m_httpPending) conns.push_back(Connection{std::move(p), now, {}, 0, 0, false});
+      m_httpPending.clear();
+    }
+
+    for (auto& c : conns) {
+      while (c.http.fd >= 0) {
+        if (c.replying) {
+          // Write as much of the current reply as the socket takes.
+          const std::size_t headBefore = c.headSent;
+          const off_t bodyBefore = c.bodySent;
+          bool ok = true;
+          bool blocked = false;
+          while (ok && !blocked && c.headSent < c.reply.head.size()) {
+            const ssize_t n = ::send(c.http.fd, c.reply.head.data() + c.headSent, c.reply.head.size() - c.headSent,
+                                     MSG_NOSIGNAL | (c.reply.fileFd >= 0 ? MSG_MORE : 0));
+            if (n > 0) c.headSent += static_cast<std::size_t>(n);
+            else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) blocked = true;
+            else ok = n < 0 && errno == EINTR;
+          }
+          while (ok && !blocked && c.reply.fileFd >= 0 && c.bodySent < c.reply.fileSize) {
+            // Body straight from the page cache.
+            const std::size_t remaining = static_cast<std::size_t>(c.reply.fileSize - c.bodySent);
+#if defined(__linux__)
+            const ssize_t n = ::sendfile(c.http.fd, c.reply.fileFd, &c.bodySent, remaining);
+#else
+            char chunk[16 * 1024];
+            ssize_t n = ::pread(c.reply.fileFd, chunk, std::min(sizeof(chunk), remaining), c.bodySent);
+            if (n > 0) n = ::send(c.http.fd, chunk, static_cast<std::size_t>(n), MSG_NOSIGNAL);
+            if (n > 0) c.bodySent += n;
+#endif
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) blocked = true;
+            else if (n <= 0) ok = n < 0 && errno == EINTR;
+          }
+          if (c.headSent != headBefore || c.bodySent != bodyBefore) c.lastActive = now;
+          if (!ok) {
+            finishReply(c);
+            closeFd_(c.http.fd);
+            break;
+          }
+          if (blocked) break;
+          if (c.reply.upgrade) {
+            // Whatever followed the upgrade request starts the WebSocket stream.
+            if (!addClient_(c.http.fd, c.reply.binary, std::move(c.http.buffer))) closeFd_(c.http.fd);
+            c.http.fd = -1;
+            break;
+          }
+          const bool keepAlive = c.reply.keepAlive;
+          finishReply(c);
+          if (!keepAlive) {
+            closeFd_(c.http.fd);
+            break;
+          }
+        }
+
+        // Next request; they may be pipelined.
+        const std::size_t end = c.http.buffer.find("\r\n\r\n");
+        if (end == std::string::npos) break;
+        const std::string head = c.http.buffer.substr(0, end + 4);
+        c.http.buffer.erase(0, end + 4);
+        c.lastActive = now;
+
+        if (!headerValue(head, "Sec-WebSocket-Key").empty()) {
+          c.reply = upgradeReply_(head);
+        } else if (!m_staticRoot.empty()) {
+          c.reply = serveHttp_(head);
+        } else {
+          closeFd_(c.http.fd);
+          break;
+        }
+        c.headSent = 0;
+        c.bodySent = 0;
+        c.replying = true;
+      }
+      // An upgrading client may already be sending frames.
+      if (c.http.fd >= 0 && !c.reply.upgrade && c.http.buffer.size() > kMaxRequestHeadBytes) closeFd_(c.http.fd);
+      if (c.http.fd >= 0 && now - c.lastActive > std::chrono::milliseconds(kHttpIdleTimeoutMs)) closeFd_(c.http.fd);
+      if (c.http.fd < 0) finishReply(c);
+    }
+    conns.erase(std::remove_if(conns.begin(), conns.end(), [](const Connection& c) { return c.http.fd < 0; }),
+                conns.end());
+
+    // The wake pipe comes last, so fds[i] matches conns[i].
+    fds.clear();
+    for (const auto& c : conns)
+      fds.push_back(pollfd{c.http.fd, static_cast<short>(POLLIN | (c.replying ? POLLOUT : 0)), 0});
+    fds.push_back(pollfd{m_httpWake[0], POLLIN, 0});
+    if (::poll(fds.data(), fds.size(), 50) <= 0) continue;
+    if (fds.back().revents & POLLIN) {
+      while (::read(m_httpWake[0], buf, sizeof(buf)) > 0) {
+      }
+    }
+    fds.pop_back();
+
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+      // POLLOUT needs no action here: the next round continues the reply.
+      if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+      const ssize_t n = ::recv(fds[i].fd, buf, sizeof(buf), MSG_DONTWAIT);
+      if (n > 0) {
+        conns[i].http.buffer.append(buf, static_cast<std::size_t>(n));
+      } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        closeFd_(conns[i].http.fd);
+        finishReply(conns[i]);
+      }
     }
+    conns.erase(std::remove_if(conns.begin(), conns.end(), [](const Connection& c) { return c.http.fd < 0; }),
+                conns.end());
+  }
+
+  for (auto& c : conns) {
+    finishReply(c);
+    closeFd_(c.http.fd);
   }
 }
 
+WebSocketServer::HttpReply WebSocketServer::serveHttp_(const std::string& head) const {
+  // Request line: METHOD SP target SP HTTP/x.y
+  const std::size_t lineEnd = head.find("\r\n");
+  std::istringstream line(head.substr(0, lineEnd));
+  std::string method, target, version;
+  line >> method >> target >> version;
+
+  const std::string connection = headerValue(head, "Connection");
+  HttpReply reply;
+  reply.keepAlive = version == "HTTP/1.1" ? !equalsIgnoreCase(connection, "close")
+                                          : equalsIgnoreCase(connection, "keep-alive");
+
+  auto respond = [&](const std::string& status, const std::string& extraHeaders, const std::string& body) {
+    reply.head =
+        "HTTP/1.1 " + status + "\r\n" + extraHeaders +
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: " + (reply.keepAlive ? "keep-alive" : "close") + "\r\n"
+        "\r\n" + (method == "HEAD" ? std::string{} : body);
+    return reply;
+  };
+  auto textError = [&](const std::string& status, const std::string& extraHeaders = {}) {
+    return respond(status, "Content-Type: text/plain; charset=utf-8\r\n" + extraHeaders, status + "\n");
+  };
+
+  if (version.compare(0, 5, "HTTP/") != 0 || target.empty() || target[0] != '/') {
+    reply.keepAlive = false;
+    return textError("400 Bad Request");
+  }
+  if (method != "GET" && method != "HEAD") {
+    // Bodies are not read, so the connection cannot be reused.
+    reply.keepAlive = false;
+    return textError("405 Method Not Allowed", "Allow: GET, HEAD\r\n");
+  }
+
+  std::string path;
+  if (!decodePath(target.substr(0, target.find_first_of("?#")), path)) return textError("400 Bad Request");
+  for (std::size_t start = 0; start < path.size();) {
+    const std::size_t end = std::min(path.find('/', start + 1), path.size());
+    if (path.compare(start, end - start, "/..") == 0) return textError("403 Forbidden");
+    start = end;
+  }
+
+  std::string file = m_staticRoot + path;
+  struct stat st {};
+  if (::stat(file.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    if (path.back() != '/') {
+      // Relative URLs in the index page need the trailing slash.
+      return respond("301 Moved Permanently", "Location: " + target.substr(0, target.find_first_of("?#")) + "/\r\n",
+                     {});
+    }
+    file += "index.html";
+  }
+
+  // Resolve symlinks and make sure the result is still below the root.
+  char resolved[PATH_MAX];
+  if (!::realpath(file.c_str(), resolved) || ::stat(resolved, &st) != 0 || !S_ISREG(st.st_mode))
+    return textError("404 Not Found");
+  file = resolved;
+  const std::string rootPrefix = m_staticRoot.back() == '/' ? m_staticRoot : m_staticRoot + "/";
+  if (file.compare(0, rootPrefix.size(), rootPrefix) != 0) return textError("404 Not Found");
+
+  // Precompressed variant next to the file, if the client accepts it.
+  const std::string acceptEncoding = headerValue(head, "Accept-Encoding");
+  const char* encoding = nullptr;
+  std::string served = file;
+  for (const auto& variant : {std::make_pair("br", ".br"), std::make_pair("gzip", ".gz")}) {
+    struct stat vst {};
+    const std::string candidate = file + variant.second;
+    if (acceptsEncoding(acceptEncoding, variant.first) && ::stat(candidate.c_str(), &vst) == 0 &&
+        S_ISREG(vst.st_mode)) {
+      encoding = variant.first;
+      served = candidate;
+      st = vst;
+      break;
+    }
+  }
+
+  const std::string etag = makeETag(st, encoding ? (std::string("-") + encoding).c_str() : "");
+  std::string headers =
+      std::string("Content-Type: ") + contentType(file) + "\r\n"
+      "ETag: " + etag + "\r\n"
+      "Cache-Control: no-cache\r\n"
+      "Vary: Accept-Encoding\r\n";
+  if (encoding) headers += std::string("Content-Encoding: ") + encoding + "\r\n";
+
+  const std::string ifNoneMatch = headerValue(head, "If-None-Match");
+  if (!ifNoneMatch.empty() && etagMatches(ifNoneMatch, etag)) {
+    reply.head = "HTTP/1.1 304 Not Modified\r\n" + headers +
+                 "Connection: " + (reply.keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+    return reply;
+  }
+
+  const int fileFd = method == "HEAD" ? -1 : ::open(served.c_str(), O_RDONLY | O_CLOEXEC);
+  if (method != "HEAD" && fileFd < 0) return textError("404 Not Found");
+
+  reply.head = "HTTP/1.1 200 OK\r\n" + headers +
+               "Content-Length: " + std::to_string(static_cast<long long>(st.st_size)) + "\r\n"
+               "Connection: " + (reply.keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+  reply.fileFd = fileFd;
+  reply.fileSize = st.st_size;
+  return reply;
+}
+
 void WebSocketServer::broadcastLoop_() {
+  applyThreadPolicy_();
+
+  if (m_pushMode) {
+    std::deque<OutgoingFrame> pending;
+    while (m_running.load() && !m_stopRequested.load()) {
+      {
+        std::unique_lock<std::mutex> lk(m_queueMutex);
+        m_queueCv.wait(lk, [this] { return m_stopRequested.load() || !m_queue.empty(); });
+        pending.swap(m_queue);
+      }
+      for (const auto& frame : pending)
+        sendToAll_(frame.payload, frame.binary, frame.binary ? Audience::BinaryClients : Audience::All);
+      pending.clear();
+    }
+    return;
+  }
+
+  std::deque<OutgoingFrame> pending;
   while (m_running.load() && !m_stopRequested.load()) {
+    // Frames pushed with broadcast() (e.g. metadata) go out before the next
+    // provider payload.
+    {
+      std::lock_guard<std::mutex> lk(m_queueMutex);
+      pending.swap(m_queue);
+    }
+    for (const auto& frame : pending)
+      sendToAll_(frame.payload, frame.binary, frame.binary ? Audience::BinaryClients : Audience::All);
+    pending.clear();
+
     const auto payload = m_provider ? m_provider() : std::string{};
+    if (m_binaryProvider) {
+      sendToAll_(payload, false, Audience::TextClients);
+      if (hasBinaryClients_()) sendToAll_(m_binaryProvider(), true, Audience::BinaryClients);
+    } else {
+      sendToAll_(payload, false, Audience::All);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(m_intervalMs));
+  }
+}
 
-    std::vector<int> clientsCopy;
-    {
-      std::lock_guard<std::mutex> lk(m_clientsMutex);
-      clientsCopy = m_clients;
+bool WebSocketServer::hasBinaryClients_() {
+  std::lock_guard<std::mutex> lk(m_clientsMutex);
+  return std::any_of(m_clients.begin(), m_clients.end(), [](const auto& c) { return c->binary; });
+}
+
+void WebSocketServer::removeClient_(std::uint64_t id) {
+  std::lock_guard<std::mutex> lk(m_clientsMutex);
+  auto it = std::find_if(m_clients.begin(), m_clients.end(), [id](const auto& c) { return c->id == id; });
+  if (it == m_clients.end()) return;
+  ::shutdown((*it)->fd, SHUT_RDWR);
+  m_clients.erase(it);
+}
+
+void WebSocketServer::sendToAll_(const std::string& payload, bool binary, Audience audience) {
+  std::vector<std::shared_ptr<Client>> clientsCopy;
+  {
+    std::lock_guard<std::mutex> lk(m_clientsMutex);
+    clientsCopy.reserve(m_clients.size());
+    for (const auto& c : m_clients) {
+      if (audience == Audience::TextClients && c->binary) continue;
+      if (audience == Audience::BinaryClients && !c->binary) continue;
+      clientsCopy.push_back(c);
     }
+  }
 
-    std::vector<int> dead;
-    for (int fd : clientsCopy) {
-      if (!sendTextFrame_(fd, payload)) dead.push_back(fd);
+  if (clientsCopy.empty()) return;
+  // Encoded once, shared by every client queue.
+  const auto frame = encodeFrame_(binary ? 0x2 : 0x1, payload);
+  for (const auto& c : clientsCopy) {
+    if (!enqueue_(*c, frame)) removeClient_(c->id);
+  }
+}
+
+bool WebSocketServer::enqueue_(Client& client, const std::shared_ptr<const std::string>& frame) {
+  std::lock_guard<std::mutex> lk(client.sendMutex);
+  if (client.outbox.empty()) client.lastProgress = std::chrono::steady_clock::now();
+  while (client.outbox.size() >= kMaxClientQueuedFrames) {
+    // Never cut into a frame that is partly on the wire.
+    const auto oldest = client.outbox.begin() + (client.frontOffset > 0 ? 1 : 0);
+    if (oldest == client.outbox.end()) break;
+    client.outbox.erase(oldest);
+  }
+  client.outbox.push_back(frame);
+  return flush_(client);
+}
+
+bool WebSocketServer::flush_(Client& client) {
+  // Caller holds client.sendMutex.
+  const auto now = std::chrono::steady_clock::now();
+  while (!client.outbox.empty()) {
+    const std::string& front = *client.outbox.front();
+    const ssize_t n = ::send(client.fd, front.data() + client.frontOffset, front.size() - client.frontOffset,
+                             MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+      break;
+    }
+    client.lastProgress = now;
+    client.frontOffset += static_cast<std::size_t>(n);
+    if (client.frontOffset == front.size()) {
+      client.outbox.pop_front();
+      client.frontOffset = 0;
     }
+  }
+  return client.outbox.empty() || now - client.lastProgress < std::chrono::milliseconds(kClientStallTimeoutMs);
+}
+
+bool WebSocketServer::hasQueuedFrames_(Client& client) {
+  std::lock_guard<std::mutex> lk(client.sendMutex);
+  return !client.outbox.empty();
+}
+
+void WebSocketServer::receiveLoop_() {
+  applyThreadPolicy_();
+
+  // The snapshot keeps every polled Client (and so its descriptor) alive
+  // until the next round, even if another thread removes it meanwhile.
+  std::vector<std::pair<std::uint64_t, IncomingMessages>> states;
+  std::vector<std::shared_ptr<Client>> clients;
+  std::vector<pollfd> fds;
+  std::vector<char> buffered;
+  std::vector<char> buf(16 * 1024);
 
-    if (!dead.empty()) {
+  while (m_running.load() && !m_stopRequested.load()) {
+    {
       std::lock_guard<std::mutex> lk(m_clientsMutex);
-      for (int d : dead) {
-        auto it = std::find(m_clients.begin(), m_clients.end(), d);
-        if (it != m_clients.end()) {
-          int fd = *it;
-          closeFd_(fd);
-          m_clients.erase(it);
+      clients = m_clients;
+    }
+    // Clients with queued frames are also flushed from here once their
+    // socket drains.
+    fds.clear();
+    for (const auto& c : clients)
+      fds.push_back(pollfd{c->fd, static_cast<short>(POLLIN | (hasQueuedFrames_(*c) ? POLLOUT : 0)), 0});
+    // Forget clients that are gone.
+    states.erase(std::remove_if(states.begin(), states.end(),
+                                [&](const auto& st) {
+                                  return std::none_of(clients.begin(), clients.end(),
+                                                      [&](const auto& c) { return c->id == st.first; });
+                                }),
+                 states.end());
+    // Bytes that arrived together with the upgrade request are parsed
+    // without waiting for the socket to become readable.
+    buffered.assign(clients.size(), 0);
+    bool anyBuffered = false;
+    for (std::size_t i = 0; i < clients.size(); ++i) {
+      if (clients[i]->initialInput.empty()) continue;
+      IncomingMessages in;
+      in.buffer = std::move(clients[i]->initialInput);
+      clients[i]->initialInput.clear();
+      states.emplace_back(clients[i]->id, std::move(in));
+      buffered[i] = 1;
+      anyBuffered = true;
+    }
+
+    if (fds.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      continue;
+    }
+    if (::poll(fds.data(), fds.size(), anyBuffered ? 0 : 50) <= 0 && !anyBuffered) continue;
+
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+      const std::uint64_t id = clients[i]->id;
+      if (fds[i].revents & POLLOUT) {
+        std::lock_guard<std::mutex> lk(clients[i]->sendMutex);
+        if (!flush_(*clients[i])) {
+          removeClient_(id);
+          continue;
         }
       }
-    }
+      const bool readable = (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+      if (!readable && !buffered[i]) continue;
+
+      auto it = std::find_if(states.begin(), states.end(), [&](const auto& st) { return st.first == id; });
+      if (it == states.end()) it = states.insert(states.end(), {id, IncomingMessages{}});
+      IncomingMessages& in = it->second;
+
+      bool drop = false;
+      if (readable) {
+        const ssize_t n = ::recv(fds[i].fd, buf.data(), buf.size(), MSG_DONTWAIT);
+        drop = n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+        if (n > 0) in.buffer.append(buf.data(), static_cast<std::size_t>(n));
+      }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(m_intervalMs));
-  }
-}
+      // Parse every complete frame in the buffer.
+      while (!drop) {
+        const std::string& b = in.buffer;
+        if (b.size() < 2) break;
+        const auto b0 = static_cast<std::uint8_t>(b[0]);
+        const auto b1 = static_cast<std::uint8_t>(b[1]);
+        const bool fin = (b0 & 0x80) != 0;
+        const int opcode = b0 & 0x0F;
+        const bool masked = (b1 & 0x80) != 0;
+
+        std::size_t header = 2;
+        std::uint64_t len = b1 & 0x7F;
+        if (len == 126) {
+          if (b.size() < 4) break;
+          len = (std::uint64_t(std::uint8_t(b[2])) << 8) | std::uint8_t(b[3]);
+          header = 4;
+        } else if (len == 127) {
+          if (b.size() < 10) break;
+          len = 0;
+          for (int k = 0; k < 8; ++k) len = (len << 8) | std::uint8_t(b[2 + static_cast<std::size_t>(k)]);
+          header = 10;
+        }
+        // Client frames must be masked (RFC 6455 5.1).
+        if (!masked || len > kMaxMessageBytes) {
+          drop = true;
+          break;
+        }
+        if (b.size() < header + 4 + len) break;
+
+        const char* mask = b.data() + header;
+        std::string payload(b.data() + header + 4, static_cast<std::size_t>(len));
+        for (std::size_t k = 0; k < payload.size(); ++k) payload[k] = static_cast<char>(payload[k] ^ mask[k % 4]);
+        in.buffer.erase(0, header + 4 + static_cast<std::size_t>(len));
+
+        if (opcode == 0x8) {
+          drop = true;
+        } else if (opcode == 0x1 || (opcode == 0x0 && in.inText)) {
+          in.message += payload;
+          in.inText = !fin;
+          if (in.message.size() > kMaxMessageBytes) {
+            drop = true;
+          } else if (fin) {
+            // A throwing handler must not take the receive thread (and the
+            // process) down with it.
+            try {
+              if (m_messageHandler) m_messageHandler(in.message);
+            } catch (...) {
+            }
+            in.message.clear();
+          }
+        }
+      }
 
-bool WebSocketServer::sendAll_(int fd, const void* data, std::size_t len) {
-  const std::uint8_t* p = static_cast<const std::uint8_t*>(data);
-  std::size_t sent = 0;
-  while (sent < len) {
-    const ssize_t n = ::send(fd, p + sent, len - sent, 0);
-    if (n <= 0) return false;
-    sent += static_cast<std::size_t>(n);
+      if (drop) removeClient_(id);
+    }
   }
-  return true;
 }
 
-bool WebSocketServer::sendTextFrame_(int fd, const std::string& text) {
+std::shared_ptr<const std::string> WebSocketServer::encodeFrame_(std::uint8_t opcode, const std::string& payload) {
   // Server-to-client frames are not masked.
-  // FIN=1, opcode=1
-  std::vector<std::uint8_t> frame;
-  frame.reserve(2 + 8 + text.size());
-  frame.push_back(0x81);
+  // FIN=1, opcode=1 (text) or 2 (binary)
+  std::string frame;
+  frame.reserve(2 + 8 + payload.size());
+  frame.push_back(static_cast<char>(0x80 | opcode));
 
-  const std::size_t n = text.size();
+  const std::size_t n = payload.size();
   if (n <= 125) {
-    frame.push_back(static_cast<std::uint8_t>(n));
+    frame.push_back(static_cast<char>(n));
   } else if (n <= 0xFFFF) {
-    frame.push_back(126);
-    frame.push_back(static_cast<std::uint8_t>((n >> 8) & 0xFF));
-    frame.push_back(static_cast<std::uint8_t>(n & 0xFF));
+    frame.push_back(static_cast<char>(126));
+    frame.push_back(static_cast<char>((n >> 8) & 0xFF));
+    frame.push_back(static_cast<char>(n & 0xFF));
   } else {
-    frame.push_back(127);
-    for (int i = 7; i >= 0; --i) frame.push_back(static_cast<std::uint8_t>((n >> (i * 8)) & 0xFF));
+    frame.push_back(static_cast<char>(127));
+    for (int i = 7; i >= 0; --i) frame.push_back(static_cast<char>((n >> (i * 8)) & 0xFF));
   }
 
-  frame.insert(frame.end(), text.begin(), text.end());
-  return sendAll_(fd, frame.data(), frame.size());
+  frame += payload;
+  return std::make_shared<const std::string>(std::move(frame));
 }
 
 void WebSocketServer::closeFd_(int& fd) {
@@ -203,7 +898,7 @@ void WebSocketServer::closeFd_(int& fd) {
   }
 }
 
-std::string WebSocketServer::makeAcceptKey_(const std::string& secWebSocketKey) {
+std::string WebSocketServer::makeAcceptKey(const std::string& secWebSocketKey) {
   const std::string guid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
   const auto digest = sha1_(secWebSocketKey + guid);
   return base64Encode_(digest);
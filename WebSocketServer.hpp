@@ -1,22 +1,44 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include <sys/types.h>
+
+#include "ThreadTuning.hpp"
+
 // Minimal WebSocket (RFC6455) server for local demos.
-// - Supports a single text broadcast to all connected clients
+// - Supports a single text broadcast to all connected clients, either pulled
+//   from a PayloadProvider every intervalMs or pushed with broadcast()
 // - Implements HTTP Upgrade + Sec-WebSocket-Accept
-// - Ignores incoming frames (clients may send pings; we don't parse them)
+// - Client sockets are non-blocking with a small queue each: a slow reader
+//   loses its oldest unsent frames instead of delaying everyone else, and
+//   one that accepts nothing for kClientStallTimeoutMs is dropped
+// - Clients that connect with ?format=binary in the request target receive
+//   binary frames (setBinaryProvider() / broadcastBinary()) in place of the
+//   provider's text payload, e.g. raw float32 bins for a typed array
+// - Text messages from clients go to an optional MessageHandler (e.g. for
+//   control commands); pings and binary frames are ignored, a close frame
+//   drops the client
+// - Optionally serves plain HTTP GET/HEAD requests for files under a static
+//   directory on the same port (sendfile, ETag / If-None-Match, precompressed
+//   .br / .gz variants, keep-alive), so one process serves both the UI and
+//   the stream
 //
 // Intended for visualization/telemetry, not production.
 class WebSocketServer final {
 public:
   using PayloadProvider = std::function<std::string()>;
+  using MessageHandler = std::function<void(const std::string& text)>;
 
   explicit WebSocketServer(int port);
   ~WebSocketServer();
@@ -25,20 +47,131 @@ public:
   WebSocketServer& operator=(const WebSocketServer&) = delete;
 
   void start(PayloadProvider provider, int intervalMs = 100);
+
+  // Push mode: frames queued with broadcast() are sent in order by the
+  // broadcast thread. The queue is bounded; the oldest frames are dropped
+  // when clients cannot keep up.
+  // In provider mode broadcast() also works; queued frames are sent before
+  // the next provider payload.
+  void start();
+  void broadcast(std::string text);
+
+  // Binary counterpart of the provider, called each interval only while a
+  // binary client is connected; those clients then no longer receive the
+  // provider's text payload. Set before start(). Text frames queued with
+  // broadcast() (e.g. metadata) still go to every client.
+  void setBinaryProvider(PayloadProvider provider);
+  // Queues a binary frame for binary clients only.
+  void broadcastBinary(std::string data);
+
+  // Called on the receive thread for every complete text message; set before
+  // start(). Exceptions thrown by the handler are swallowed.
+  void setMessageHandler(MessageHandler handler);
+
+  // Serve files below directory for requests without Sec-WebSocket-Key
+  // ("/" and other directories map to index.html); set before start().
+  // Returns false if directory does not exist. Without it such requests are
+  // closed as before.
+  bool setStaticRoot(const std::string& directory, std::string* error = nullptr);
+
   void stop();
 
   bool isRunning() const noexcept { return m_running.load(); }
+  std::size_t clientCount();
+
+  // Applied to the accept and broadcast threads when they start; set before
+  // start(). Failures are best-effort and reported by threadPolicyError().
+  void setThreadPolicy(const ThreadPolicy& policy);
+  std::string threadPolicyError();
+
+  // Sec-WebSocket-Accept value for a client's Sec-WebSocket-Key
+  // (RFC 6455 4.2.2); also lets clients check the handshake reply.
+  static std::string makeAcceptKey(const std::string& secWebSocketKey);
 
 private:
+  static constexpr std::size_t kMaxQueuedFrames = 1024;
+  static constexpr std::size_t kMaxMessageBytes = 64 * 1024;
+  static constexpr std::size_t kMaxClientQueuedFrames = 64;
+  // Caps what the kernel buffers per client (loopback autotuning would allow
+  // megabytes), so a slow reader gets recent frames rather than old ones.
+  static constexpr int kClientSendBufferBytes = 64 * 1024;
+  static constexpr int kClientStallTimeoutMs = 10000;
+  static constexpr std::size_t kMaxRequestHeadBytes = 8192;
+  static constexpr int kHttpIdleTimeoutMs = 5000;
+
+  // Owns the socket: it is closed when the last reference goes away, so a
+  // thread still polling or sending to a removed client never reaches a
+  // descriptor number that accept() has handed out again.
+  struct Client {
+    Client(int fd_, std::uint64_t id_, bool binary_) : fd(fd_), id(id_), binary(binary_) {}
+    ~Client();
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    const int fd;
+    const std::uint64_t id;
+    const bool binary; // connected with ?format=binary
+    // Bytes that arrived right behind the upgrade request (e.g. a first
+    // frame); set before the client is published, then parsed and cleared
+    // by the receive thread.
+    std::string initialInput;
+
+    // Encoded frames not yet fully written; the front one may be partly
+    // sent. Written by whichever of the broadcast and receive threads finds
+    // the socket writable.
+    std::mutex sendMutex;
+    std::deque<std::shared_ptr<const std::string>> outbox;
+    std::size_t frontOffset = 0;
+    std::chrono::steady_clock::time_point lastProgress;
+  };
+
+  enum class Audience { All, TextClients, BinaryClients };
+
+  struct OutgoingFrame {
+    std::string payload;
+    bool binary;
+  };
+
   void acceptLoop_();
   void broadcastLoop_();
+  void receiveLoop_();
+  void httpLoop_();
+
+  // What to write for one HTTP request: head (status line, headers and any
+  // small body), then optionally fileSize bytes of fileFd. After an upgrade
+  // reply the socket becomes a WebSocket client.
+  struct HttpReply {
+    std::string head;
+    int fileFd = -1;
+    off_t fileSize = 0;
+    bool keepAlive = false;
+    bool upgrade = false;
+    bool binary = false; // upgrade requested ?format=binary
+  };
+
+  // Builds the reply to one request; the HTTP thread writes it.
+  static HttpReply upgradeReply_(const std::string& head);
+  HttpReply serveHttp_(const std::string& head) const;
+  // leftover: bytes read after the upgrade request, handed to the receive
+  // thread as the start of the WebSocket stream.
+  bool addClient_(int fd, bool binary, std::string leftover);
+  void sendToAll_(const std::string& payload, bool binary, Audience audience);
+  // Queues one encoded frame, dropping the oldest unsent ones beyond
+  // kMaxClientQueuedFrames, and writes what the socket takes. Returns false
+  // if the client has to be dropped.
+  static bool enqueue_(Client& client, const std::shared_ptr<const std::string>& frame);
+  // Writes queued frames until the socket would block.
+  static bool flush_(Client& client);
+  static bool hasQueuedFrames_(Client& client);
+  bool hasBinaryClients_();
+  // Drops the client from m_clients and shuts its socket down; the
+  // descriptor closes once nobody holds the Client any more.
+  void removeClient_(std::uint64_t id);
 
-  static std::string makeAcceptKey_(const std::string& secWebSocketKey);
   static std::string base64Encode_(const std::vector<std::uint8_t>& data);
   static std::vector<std::uint8_t> sha1_(const std::string& s);
 
-  static bool sendAll_(int fd, const void* data, std::size_t len);
-  static bool sendTextFrame_(int fd, const std::string& text);
+  static std::shared_ptr<const std::string> encodeFrame_(std::uint8_t opcode, const std::string& payload);
   static void closeFd_(int& fd);
 
   const int m_port;
@@ -47,13 +180,41 @@ private:
 
   std::thread m_acceptThread;
   std::thread m_broadcastThread;
+  std::thread m_receiveThread;
+  std::thread m_httpThread;
 
   PayloadProvider m_provider;
+  PayloadProvider m_binaryProvider;
+  MessageHandler m_messageHandler;
   int m_intervalMs = 100;
+  bool m_pushMode = false;
+
+  std::mutex m_queueMutex;
+  std::condition_variable m_queueCv;
+  std::deque<OutgoingFrame> m_queue;
 
   int m_listenFd = -1;
 
   std::mutex m_clientsMutex;
-  std::vector<int> m_clients;
+  std::vector<std::shared_ptr<Client>> m_clients;
+  std::uint64_t m_nextClientId = 0;
+
+  // Accepted connections handed over by the accept thread before anything
+  // is read (non-blocking; buffer holds what has been read so far). The
+  // HTTP thread reads every request head and answers or upgrades it.
+  struct HttpConnection {
+    int fd;
+    std::string buffer;
+  };
+  std::string m_staticRoot; // canonical path, empty if disabled
+  std::mutex m_httpMutex;
+  std::vector<HttpConnection> m_httpPending;
+  int m_httpWake[2] = {-1, -1}; // pipe: the accept thread wakes the HTTP thread's poll
+
+  void applyThreadPolicy_();
+
+  ThreadPolicy m_threadPolicy;
+  std::mutex m_policyErrorMutex;
+  std::string m_policyError;
 };
 
@@ -0,0 +1,94 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+namespace {
+// Pool and queue index of the worker running on this thread, if any.
+thread_local const WorkStealingPool* tlsPool = nullptr;
+thread_local std::size_t tlsIndex = 0;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int workers) {
+  std::size_t n = workers > 0 ? static_cast<std::size_t>(workers)
+                              : static_cast<std::size_t>(std::thread::hardware_concurrency());
+  n = std::max<std::size_t>(1, n);
+
+  m_queues.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) m_queues.push_back(std::make_unique<Queue>());
+
+  m_workers.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) m_workers.emplace_back(&WorkStealingPool::workerLoop_, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lk(m_sleepMutex);
+    m_stopping = true;
+  }
+  m_sleepCv.notify_all();
+  for (auto& t : m_workers)
+    if (t.joinable()) t.join();
+}
+
+void WorkStealingPool::submit(Task task) {
+  const std::size_t index = (tlsPool == this)
+      ? tlsIndex
+      : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+  {
+    // Counted before it is queued so m_pending never underflows; taken under
+    // the sleep mutex so a worker about to wait cannot miss it.
+    std::lock_guard<std::mutex> lk(m_sleepMutex);
+    m_pending.fetch_add(1, std::memory_order_release);
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_queues[index]->mutex);
+    m_queues[index]->tasks.push_back(std::move(task));
+  }
+  m_sleepCv.notify_one();
+}
+
+bool WorkStealingPool::tryPop_(std::size_t index, Task& out) {
+  Queue& q = *m_queues[index];
+  std::lock_guard<std::mutex> lk(q.mutex);
+  if (q.tasks.empty()) return false;
+  out = std::move(q.tasks.front());
+  q.tasks.pop_front();
+  return true;
+}
+
+bool WorkStealingPool::trySteal_(std::size_t thief, Task& out) {
+  const std::size_t n = m_queues.size();
+  for (std::size_t k = 1; k < n; ++k) {
+    Queue& q = *m_queues[(thief + k) % n];
+    std::lock_guard<std::mutex> lk(q.mutex);
+    if (q.tasks.empty()) continue;
+    out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::workerLoop_(std::size_t index) {
+  tlsPool = this;
+  tlsIndex = index;
+
+  Task task;
+  for (;;) {
+    if (tryPop_(index, task) || trySteal_(index, task)) {
+      m_pending.fetch_sub(1, std::memory_order_acq_rel);
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lk(m_sleepMutex);
+    m_sleepCv.wait(lk, [this] {
+      return m_stopping.load() || m_pending.load(std::memory_order_acquire) > 0;
+    });
+    if (m_stopping.load() && m_pending.load(std::memory_order_acquire) == 0) break;
+  }
+
+  tlsPool = nullptr;
+}
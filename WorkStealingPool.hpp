@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with one task deque per worker.
+// - submit() from a worker pushes to that worker's own deque; from any other
+//   thread tasks are spread round-robin
+// - Workers pop their own deque from the front and steal from the back of the
+//   others when idle, then sleep until new work arrives
+//
+// Tasks must not throw. Pending tasks are still run by the destructor.
+class WorkStealingPool final {
+public:
+  using Task = std::function<void()>;
+
+  // workers <= 0 uses std::thread::hardware_concurrency().
+  explicit WorkStealingPool(int workers = 0);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  void submit(Task task);
+
+  std::size_t size() const noexcept { return m_queues.size(); }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop_(std::size_t index);
+  bool tryPop_(std::size_t index, Task& out);
+  bool trySteal_(std::size_t thief, Task& out);
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_workers;
+
+  std::atomic<bool> m_stopping{false};
+  std::atomic<std::size_t> m_nextQueue{0};
+  std::atomic<std::size_t> m_pending{0};
+
+  std::mutex m_sleepMutex;
+  std::condition_variable m_sleepCv;
+};
@@ -0,0 +1,138 @@
+#include "ZoomFft.hpp"
+
+#include "DspPipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dsp {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+} // namespace
+
+bool ZoomAnalyzer::valid(int sampleRate, const ZoomBand& band) {
+    if (sampleRate <= 0 || band.fftSize < 2 || band.fftSize > kMaxFftSize) return false;
+    if ((band.fftSize & (band.fftSize - 1)) != 0) return false;
+    // Also false for NaN.
+    if (!(band.lowHz >= 0.0f && band.highHz > band.lowHz && band.highHz < sampleRate * 0.5f)) return false;
+    const double span = static_cast<double>(band.highHz) - band.lowHz;
+    return sampleRate / (2.0 * span) < kMaxDecimation + 1.0;
+}
+
+ZoomAnalyzer::ZoomAnalyzer(int sampleRate, const ZoomBand& band) : m_band(band) {
+    if (m_band.fftSize < 2) m_band.fftSize = 2;
+    const double span = std::max(1e-3, static_cast<double>(m_band.highHz) - m_band.lowHz);
+    const double center = 0.5 * (static_cast<double>(m_band.lowHz) + m_band.highHz);
+
+    m_decimation = std::max(1, static_cast<int>(sampleRate / (2.0 * span)));
+    const double decimatedRate = static_cast<double>(sampleRate) / m_decimation;
+    const std::size_t n = static_cast<std::size_t>(m_band.fftSize);
+
+    // FFT bin k (after moving DC to the middle) sits at center + (k - n/2) * binHz;
+    // keep the ones inside the band.
+    const double binHz = decimatedRate / static_cast<double>(n);
+    const long half = static_cast<long>(n / 2);
+    const long first = std::max(-half, static_cast<long>(std::ceil((m_band.lowHz - center) / binHz)));
+    const long last = std::min(half - 1, static_cast<long>(std::floor((m_band.highHz - center) / binHz)));
+    m_firstBin = static_cast<std::size_t>(first + half);
+    m_binCount = last >= first ? static_cast<std::size_t>(last - first + 1) : 0;
+    m_binHz = static_cast<float>(binHz);
+    m_startHz = static_cast<float>(center + first * binHz);
+
+    const double step = -2.0 * kPi * center / sampleRate;
+    m_stepR = std::cos(step);
+    m_stepI = std::sin(step);
+
+    // Cutoff at half the decimated rate: the band lies within decimatedRate / 4
+    // of DC and passes untouched, and the transition band ends before
+    // anything that would alias into it.
+    const std::size_t taps = static_cast<std::size_t>(12 * m_decimation + 1);
+    const double fc = 0.5 / m_decimation; // cycles per input sample
+    const double mid = 0.5 * static_cast<double>(taps - 1);
+    m_taps.resize(taps);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < taps; ++i) {
+        const double t = static_cast<double>(i) - mid;
+        const double sinc = (t == 0.0) ? 2.0 * fc : std::sin(2.0 * kPi * fc * t) / (kPi * t);
+        const double x = taps > 1 ? static_cast<double>(i) / static_cast<double>(taps - 1) : 0.5;
+        const double blackman = 0.42 - 0.5 * std::cos(2.0 * kPi * x) + 0.08 * std::cos(4.0 * kPi * x);
+        m_taps[i] = static_cast<float>(sinc * blackman);
+        sum += sinc * blackman;
+    }
+    for (float& t : m_taps) t = static_cast<float>(t / sum);
+    m_history.assign(2 * taps, FftComplex{0.0f, 0.0f});
+
+    m_ring.assign(n, FftComplex{0.0f, 0.0f});
+    m_window.resize(n);
+    for (std::size_t i = 0; i < n; ++i) m_window[i] = hannWindow(static_cast<int>(i), static_cast<int>(n));
+    m_block.resize(n);
+    m_spectrum.resize(n);
+    m_fft = std::make_unique<ComplexFft>(static_cast<int>(n));
+    m_out.assign(m_binCount, 0.0f);
+}
+
+void ZoomAnalyzer::push(const float* samples, std::size_t count) {
+    const std::size_t taps = m_taps.size();
+
+    for (std::size_t s = 0; s < count; ++s) {
+        const FftComplex mixed{
+            static_cast<float>(samples[s] * m_phaseR),
+            static_cast<float>(samples[s] * m_phaseI)
+        };
+        const double r = m_phaseR * m_stepR - m_phaseI * m_stepI;
+        m_phaseI = m_phaseR * m_stepI + m_phaseI * m_stepR;
+        m_phaseR = r;
+
+        m_history[m_historyPos] = mixed;
+        m_history[m_historyPos + taps] = mixed;
+        m_historyPos = (m_historyPos + 1) % taps;
+
+        if (++m_phase < m_decimation) continue;
+        m_phase = 0;
+
+        // Oldest sample first: history[pos .. pos + taps).
+        const FftComplex* h = m_history.data() + m_historyPos;
+        float re = 0.0f;
+        float im = 0.0f;
+        for (std::size_t i = 0; i < taps; ++i) {
+            re += m_taps[i] * h[i].r;
+            im += m_taps[i] * h[i].i;
+        }
+        m_ring[m_ringPos] = FftComplex{re, im};
+        m_ringPos = (m_ringPos + 1) % m_ring.size();
+        m_filled = std::min(m_filled + 1, m_ring.size());
+    }
+
+    // Keep the phasor on the unit circle.
+    const double mag = std::sqrt(m_phaseR * m_phaseR + m_phaseI * m_phaseI);
+    m_phaseR /= mag;
+    m_phaseI /= mag;
+}
+
+const std::vector<float>& ZoomAnalyzer::compute() {
+    capture();
+    return transform();
+}
+
+void ZoomAnalyzer::capture() {
+    const std::size_t n = m_ring.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        const FftComplex& x = m_ring[(m_ringPos + i) % n];
+        m_block[i] = FftComplex{x.r * m_window[i], x.i * m_window[i]};
+    }
+}
+
+const std::vector<float>& ZoomAnalyzer::transform() {
+    const std::size_t n = m_ring.size();
+    m_fft->forward(m_block.data(), m_spectrum.data());
+
+    // Shifted bin k is FFT bin (k + n/2) mod n.
+    for (std::size_t b = 0; b < m_binCount; ++b) {
+        const FftComplex& c = m_spectrum[(m_firstBin + b + n / 2) % n];
+        m_out[b] = std::sqrt(c.r * c.r + c.i * c.i);
+    }
+    return m_out;
+}
+
+} // namespace dsp
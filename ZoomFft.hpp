@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Fft.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace dsp {
+
+// Narrow band to inspect at fine resolution.
+// fftSize is the size of the small FFT run on the decimated signal.
+struct ZoomBand {
+    float lowHz = 0.0f;
+    float highHz = 0.0f;
+    int fftSize = 256;
+};
+
+// Zoom FFT: the band is mixed down to baseband, low-pass filtered and
+// decimated as samples arrive, and compute() runs a complex FFT of the latest
+// fftSize decimated samples.
+// - Decimation D = sampleRate / (2 * bandwidth), so the decimated rate is at
+//   least twice the bandwidth and aliases fold outside the band
+// - The decimation filter is a Blackman-windowed sinc of 12 * D taps with unit
+//   DC gain, evaluated only for the samples that are kept
+// - Bin spacing is sampleRate / (D * fftSize), independent of the main FFT;
+//   magnitudes are unnormalised like the main spectrum
+//
+// push() must not run concurrently with compute() or capture(); transform()
+// only touches its own buffers and may overlap push(), so the FFT can run
+// outside whatever lock guards the capture path.
+class ZoomAnalyzer {
+public:
+    // Limits that keep the filter and buffers small: the decimation filter
+    // has 12 * decimation taps, so very narrow bands are refused rather than
+    // allocating without bound.
+    static constexpr int kMaxFftSize = 8192;
+    static constexpr int kMaxDecimation = 4096;
+
+    ZoomAnalyzer(int sampleRate, const ZoomBand& band);
+
+    // Returns false if the band is empty, not below Nyquist or so narrow that
+    // the decimation would exceed kMaxDecimation, or if fftSize is not a
+    // power of two in [2, kMaxFftSize].
+    static bool valid(int sampleRate, const ZoomBand& band);
+
+    void push(const float* samples, std::size_t count);
+
+    // Linear-frequency magnitudes covering [lowHz, highHz]; bin i is centred
+    // at startHz() + i * binHz(). Same as capture() followed by transform().
+    const std::vector<float>& compute();
+
+    // Copies the latest fftSize decimated samples, windowed, for transform().
+    void capture();
+    // FFT of the last capture().
+    const std::vector<float>& transform();
+
+    const ZoomBand& band() const noexcept { return m_band; }
+    float startHz() const noexcept { return m_startHz; }
+    float binHz() const noexcept { return m_binHz; }
+    int decimation() const noexcept { return m_decimation; }
+
+    // Decimated samples received so far, capped at fftSize; compute() zero-pads
+    // until the window has filled.
+    std::size_t filled() const noexcept { return m_filled; }
+
+private:
+    ZoomBand m_band;
+    int m_decimation;
+    float m_startHz;
+    float m_binHz;
+    std::size_t m_firstBin;
+    std::size_t m_binCount;
+
+    // Mixer: unit phasor rotated by -2*pi*centre/sampleRate per sample.
+    double m_phaseR = 1.0;
+    double m_phaseI = 0.0;
+    double m_stepR;
+    double m_stepI;
+
+    // Mixed samples, the last taps.size() of them, stored twice so the filter
+    // always reads one contiguous span.
+    std::vector<float> m_taps;
+    std::vector<FftComplex> m_history;
+    std::size_t m_historyPos = 0;
+    int m_phase = 0; // input samples since the last kept one
+
+    // Decimated ring and FFT buffers.
+    std::vector<FftComplex> m_ring;
+    std::size_t m_ringPos = 0;
+    std::size_t m_filled = 0;
+    std::vector<float> m_window;
+    std::vector<FftComplex> m_block;
+    std::vector<FftComplex> m_spectrum;
+    std::unique_ptr<ComplexFft> m_fft;
+    std::vector<float> m_out;
+};
+
+} // namespace dsp
@@ -0,0 +1,118 @@
+// Hop-completion latency report: runs the same engine with and without the
+// real-time options (SCHED_FIFO, CPU pinning, mlockall + prefault) and prints
+// latency percentiles. Optional busy threads simulate a loaded host.
+//
+// Usage: bench_jitter [seconds] [hopMs] [loadThreads] [cpu] [priority]
+
+#include "AudioEngine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Args {
+    int seconds = 5;
+    int hopMs = 10;
+    int loadThreads = 0;
+    int cpu = -1;
+    int priority = 80;
+};
+
+float percentile(std::vector<float> v, double p) {
+    if (v.empty()) return 0.0f;
+    std::sort(v.begin(), v.end());
+    const std::size_t idx = std::min(v.size() - 1, static_cast<std::size_t>(p * (v.size() - 1) + 0.5));
+    return v[idx];
+}
+
+std::vector<float> run(const Args& args, bool tuned) {
+    AudioEngine engine(48000, 2048, 128, "");
+    engine.reconfigure(2048, 128, args.hopMs);
+
+    if (tuned) {
+        AudioEngine::RealtimeOptions options;
+        options.analysis.scheduling = ThreadPolicy::Scheduling::Fifo;
+        options.analysis.priority = args.priority;
+        if (args.cpu >= 0) options.analysis.cpus = {args.cpu};
+        options.capture = options.analysis;
+        options.capture.priority = std::min(99, args.priority + 1);
+        options.lockMemory = true;
+        engine.setRealtimeOptions(options);
+    }
+
+    std::atomic<bool> stop{false};
+
+    // Background load.
+    std::vector<std::thread> load;
+    for (int i = 0; i < args.loadThreads; ++i) {
+        load.emplace_back([&stop] {
+            volatile double x = 1.0;
+            while (!stop.load(std::memory_order_relaxed)) x = std::sqrt(x + 1.0);
+        });
+    }
+
+    engine.start();
+
+    // Synthetic capture: 256-sample blocks at the real sample rate.
+    std::thread feeder([&engine, &stop] {
+        std::vector<float> block(256);
+        std::size_t n = 0;
+        auto next = std::chrono::steady_clock::now();
+        while (!stop.load()) {
+            for (auto& s : block) s = std::sin(0.02f * float(n++));
+            engine.pushSamples(block.data(), block.size());
+            next += std::chrono::microseconds(256 * 1000000 / 48000);
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(args.seconds));
+    stop = true;
+    feeder.join();
+    for (auto& t : load) t.join();
+    engine.stop();
+
+    for (const auto& w : engine.getRealtimeWarnings()) std::cout << "  warning: " << w << "\n";
+    return engine.getHopLatenciesUs();
+}
+
+void report(const char* label, const std::vector<float>& us) {
+    std::cout << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << us.size()
+              << std::setw(10) << percentile(us, 0.50)
+              << std::setw(10) << percentile(us, 0.90)
+              << std::setw(10) << percentile(us, 0.99)
+              << std::setw(10) << percentile(us, 0.999)
+              << std::setw(10) << (us.empty() ? 0.0f : *std::max_element(us.begin(), us.end()))
+              << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args;
+    if (argc > 1) args.seconds = std::max(1, std::atoi(argv[1]));
+    if (argc > 2) args.hopMs = std::max(1, std::atoi(argv[2]));
+    if (argc > 3) args.loadThreads = std::max(0, std::atoi(argv[3]));
+    if (argc > 4) args.cpu = std::atoi(argv[4]);
+    if (argc > 5) args.priority = std::atoi(argv[5]);
+
+    std::cout << "hop=" << args.hopMs << "ms, " << args.seconds << "s per run, "
+              << args.loadThreads << " load threads\n";
+
+    const auto baseline = run(args, false);
+    const auto tuned = run(args, true);
+
+    std::cout << "latency (us)    hops       p50       p90       p99     p99.9       max\n";
+    report("default", baseline);
+    report("tuned", tuned);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Compares the fused and unfused forms of the default analysis chain
+// (snapshot + window, FFT, magnitude + log-bin average), plus the
+// compile-time specialised kernel used by FixedAudioEngine.
+//
+// Fusion only changes the element-wise stages around the FFT, so those are
+// timed on their own as well as inside a full hop. Variants alternate in
+// rounds and the best round is reported, which keeps drift and noise from
+// other processes out of the ratios.
+//
+// Usage: bench_pipeline [iterations]
+
+#include "DspPipeline.hpp"
+#include "FixedAudioEngine.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr int kRounds = 7;
+
+volatile float g_sink = 0.0f;
+
+template <typename Fn>
+double nsPerCall(Fn&& fn, int iterations) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; ++it) fn(it);
+    const auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+template <typename Chain>
+double nsPerHop(Chain& chain, const std::vector<float>& ring, int iterations, float& checksum) {
+    return nsPerCall([&](int it) {
+        const std::size_t w = static_cast<std::size_t>(it) * 97 % ring.size();
+        const auto& out = chain.run(dsp::RingView{ring.data(), ring.size(), w});
+        checksum += out[out.size() / 2];
+    }, iterations);
+}
+
+template <int SampleRate, int FftSize, int Bins>
+void benchConfig(int iterations) {
+    const dsp::Config cfg{SampleRate, FftSize, Bins};
+
+    std::vector<float> ring(static_cast<std::size_t>(cfg.fftSize));
+    for (std::size_t i = 0; i < ring.size(); ++i)
+        ring[i] = std::sin(0.05f * float(i)) + 0.1f * std::sin(1.3f * float(i));
+
+    dsp::UnfusedLogBinChain unfused;
+    dsp::LogBinChain fused;
+    dsp::FixedLogBinKernel<SampleRate, FftSize, Bins> fixed;
+    unfused.prepare(cfg);
+    fused.prepare(cfg);
+
+    const bool identical =
+        unfused.run(dsp::RingView{ring.data(), ring.size(), 0}) ==
+        fused.run(dsp::RingView{ring.data(), ring.size(), 0});
+
+    // The element-wise stages alone, on one FFT output.
+    dsp::Snapshot snapshot;
+    dsp::Window window;
+    dsp::Magnitude magnitude;
+    dsp::LogBinAverage average;
+    dsp::Fuse<dsp::Snapshot, dsp::Window> snapshotWindow;
+    dsp::Fuse<dsp::Magnitude, dsp::LogBinAverage> magnitudeAverage;
+    snapshot.prepare(cfg);
+    window.prepare(cfg);
+    magnitude.prepare(cfg);
+    average.prepare(cfg);
+    snapshotWindow.prepare(cfg);
+    magnitudeAverage.prepare(cfg);
+
+    std::vector<float> snap(snapshot.outputSize(cfg)), windowed(window.outputSize(cfg));
+    std::vector<float> mags(magnitude.outputSize(cfg)), bins(average.outputSize(cfg));
+    dsp::ForwardFft fft;
+    fft.prepare(cfg);
+    dsp::ForwardFft::output_type spectrum(fft.outputSize(cfg));
+    dsp::runStage(snapshotWindow, dsp::RingView{ring.data(), ring.size(), 0}, windowed);
+    fft.process(windowed, spectrum);
+
+    auto stagesUnfused = [&](int it) {
+        const dsp::RingView view{ring.data(), ring.size(), static_cast<std::size_t>(it) * 97 % ring.size()};
+        dsp::runStage(snapshot, view, snap);
+        dsp::runStage(window, snap, windowed);
+        dsp::runStage(magnitude, spectrum, mags);
+        dsp::runStage(average, mags, bins);
+    };
+    auto stagesFused = [&](int it) {
+        const dsp::RingView view{ring.data(), ring.size(), static_cast<std::size_t>(it) * 97 % ring.size()};
+        snapshotWindow.process(view, windowed);
+        magnitudeAverage.process(spectrum, bins);
+    };
+
+    float checksum = 0.0f;
+    double su = 1e300, sf = 1e300, u = 1e300, f = 1e300, x = 1e300;
+    for (int round = 0; round < kRounds; ++round) {
+        su = std::min(su, nsPerCall(stagesUnfused, iterations));
+        sf = std::min(sf, nsPerCall(stagesFused, iterations));
+        u = std::min(u, nsPerHop(unfused, ring, iterations, checksum));
+        f = std::min(f, nsPerHop(fused, ring, iterations, checksum));
+        x = std::min(x, nsPerHop(fixed, ring, iterations, checksum));
+    }
+    checksum += bins[0] + windowed[0];
+
+    std::cout << cfg.fftSize << "    " << cfg.logBins << "   "
+              << su << "  " << sf << "  " << (su / sf) << "x  "
+              << u << "  " << f << "  " << x << "  " << (u / f) << "x  "
+              << (identical ? "yes" : "NO") << "\n";
+
+    g_sink = checksum;  // keep results observable
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+
+    std::cout << "Best of " << kRounds << " rounds, ns per call.\n"
+              << "fftSize bins  stages: unfused  fused  speedup  hop: unfused  fused  fixed  speedup  identical\n";
+    benchConfig<44100, 1024, 64>(iterations);
+    benchConfig<48000, 2048, 128>(iterations);
+    benchConfig<48000, 4096, 128>(iterations);
+    return 0;
+}
@@ -1,26 +1,19 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <exception>
 #include <sstream>
 
 #include "AudioEngine.hpp"
+#include "JsonFormat.hpp"
 #include "WebSocketServer.hpp"
 
 // For my daughter:
 // May this little demo always remind you that you are deeply loved.
 
-static std::string jsonArray(const std::vector<float>& v) {
-    std::ostringstream oss;
-    oss << '[';
-    for (std::size_t i = 0; i < v.size(); ++i) {
-        if (i) oss << ',';
-        oss << v[i];
-    }
-    oss << ']';
-    return oss.str();
-}
-
 int main() {
+    // 44.1 kHz, 1024-point FFT, 64 log bins. The dynamic engine so clients
+    // can reconfigure it; FixedAudioEngine1024x64 is faster but fixed.
     AudioEngine engine(
         44100,
         1024,
@@ -28,27 +21,92 @@ int main() {
         "test.flac"   // "" disables FLAC
     );
 
+    // WebSocket server for Node.js visualization
+    // - Connect to ws://localhost:8787 from Node and parse JSON frames.
+    // - A {"type":"meta",...} message announces configuration changes.
+    // - Clients may send {"type":"zoom","lowHz":50,"highHz":70,"fftSize":256}
+    //   to add a zoom spectrum of that band to every frame, and
+    //   {"type":"zoom"} without a band to remove it.
+    // - {"type":"config","fftSize":4096,"logBins":128,"hopMs":50} switches the
+    //   analysis without a restart; every client then gets a new meta message.
+    // - The waterfall page is served from the same port when the demo runs
+    //   from the repository root: http://127.0.0.1:8787/
+    // Out-of-range requests are ignored; the handler runs on the server's
+    // receive thread and must not throw.
+    WebSocketServer ws(8787);
+    ws.setMessageHandler([&engine](const std::string& text) {
+        std::string type;
+        if (!jsonStringField(text, "type", type)) return;
+        if (type == "config") {
+            const auto info = engine.getInfo();
+            double fftSize = info.fftSize, logBins = info.logBins, hopMs = info.hopMs;
+            jsonNumberField(text, "fftSize", fftSize);
+            jsonNumberField(text, "logBins", logBins);
+            jsonNumberField(text, "hopMs", hopMs);
+            // Range-check before the casts; reconfigure() validates the rest.
+            if (!(fftSize >= 0.0 && fftSize <= AudioEngine::kMaxFftSize && logBins >= 0.0 &&
+                  logBins <= AudioEngine::kMaxLogBins && hopMs >= 0.0 && hopMs <= AudioEngine::kMaxHopMs))
+                return;
+            engine.reconfigure(int(fftSize), int(logBins), int(hopMs));
+            return;
+        }
+        if (type != "zoom") return;
+        double lowHz = 0.0, highHz = 0.0, fftSize = 256.0;
+        if (jsonNumberField(text, "lowHz", lowHz) && jsonNumberField(text, "highHz", highHz)) {
+            jsonNumberField(text, "fftSize", fftSize);
+            // Range-check before the casts; setZoomBand() validates the rest.
+            const double nyquist = engine.getInfo().sampleRate * 0.5;
+            if (!(lowHz >= 0.0 && highHz <= nyquist && fftSize >= 2.0 &&
+                  fftSize <= dsp::ZoomAnalyzer::kMaxFftSize))
+                return;
+            try {
+                engine.setZoomBand(float(lowHz), float(highHz), int(fftSize));
+            } catch (const std::exception& e) {
+                std::cerr << "zoom request failed: " << e.what() << "\n";
+            }
+        } else {
+            engine.clearZoomBand();
+        }
+    });
+
+    std::string staticError;
+    if (ws.setStaticRoot("node/waterfall", &staticError))
+        std::cout << "Waterfall view: http://127.0.0.1:8787/\n";
+    else
+        std::cerr << "Static files disabled: " << staticError << "\n";
+
+    engine.setReconfigureCallback([&ws](const AudioEngine::Info& info) {
+        ws.broadcast(jsonMetadata("", info.sampleRate, info.fftSize, info.logBins, info.hopMs, info.centers));
+    });
+
     engine.start();
 
     auto centers = engine.getLogBinCenters();
     for (int i = 0; i < static_cast<int>(centers.size()); i++)
         std::cout << i << ": " << centers[static_cast<std::size_t>(i)] << " Hz\n";
 
-    // WebSocket server for Node.js visualization
-    // - Connect to ws://localhost:8787 from Node and parse JSON frames.
-    WebSocketServer ws(8787);
+    // ws://127.0.0.1:8787/?format=binary clients (the waterfall page) get
+    // each frame as the raw float32 bins instead of JSON.
+    ws.setBinaryProvider([&]() {
+        const auto bins = engine.getLogBins();
+        return std::string(reinterpret_cast<const char*>(bins.data()), bins.size() * sizeof(float));
+    });
     ws.start([&]() {
         const auto bins = engine.getLogBins();
+        const auto zoom = engine.getZoomSpectrum();
         std::ostringstream oss;
-        oss << "{\"centers\":" << jsonArray(centers)
-            << ",\"bins\":" << jsonArray(bins)
-            << "}";
+        oss << "{\"centers\":" << jsonArray(engine.getLogBinCenters())
+            << ",\"bins\":" << jsonArray(bins);
+        if (!zoom.bins.empty())
+            oss << ",\"zoom\":" << jsonZoom(zoom.lowHz, zoom.highHz, zoom.startHz, zoom.binHz, zoom.bins);
+        oss << "}";
         return oss.str();
     }, 100);
 
     for (int i = 0; i < 20; i++) {
         auto bins = engine.getLogBins();
-        std::cout << "Frame " << i << " bin[10]=" << bins[10] << "\n";
+        // Clients may have reconfigured the engine to fewer bins.
+        if (bins.size() > 10) std::cout << "Frame " << i << " bin[10]=" << bins[10] << "\n";
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
 
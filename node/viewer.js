@@ -22,7 +22,8 @@ ws.on("message", (buf) => {
     return;
   }
 
-  if (!centers && Array.isArray(msg.centers)) centers = msg.centers;
+  // Centers change when the engine is reconfigured ({"type":"meta",...}).
+  if (Array.isArray(msg.centers)) centers = msg.centers;
   if (!Array.isArray(msg.bins)) return;
 
   // Render bins as an ASCII chart.
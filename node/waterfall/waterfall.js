@@ -1,6 +1,15 @@
 const qs = new URLSearchParams(location.search);
-const wsUrl = qs.get("ws") ?? "ws://127.0.0.1:8787";
-const maxRows = Number(qs.get("rows") ?? "200");
+// When the C++ demo serves this page, the stream is on the same host and port.
+const sameOrigin = location.protocol === "http:" || location.protocol === "https:";
+const wsUrl = qs.get("ws") ?? (sameOrigin
+  ? `${location.protocol === "https:" ? "wss" : "ws"}://${location.host}`
+  : "ws://127.0.0.1:8787");
+const maxRows = Math.max(1, Number(qs.get("rows") ?? "200") || 200);
+
+// Ask for raw float32 frames; servers without binary support keep sending
+// JSON, which is handled too.
+const streamUrl = new URL(wsUrl);
+streamUrl.searchParams.set("format", "binary");
 
 const wsUrlEl = document.getElementById("wsUrl");
 const statusEl = document.getElementById("status");
@@ -8,19 +17,24 @@ const rowsEl = document.getElementById("rows");
 const binsEl = document.getElementById("bins");
 
 wsUrlEl.textContent = wsUrl;
-rowsEl.textContent = String(Number.isFinite(maxRows) ? maxRows : 200);
-
-// History as rows of 64 values (oldest at top, newest appended).
-let history = [];
-let nBins = 64;
-
-// Auto scale for color mapping (simple peak-hold with decay)
-let colorMax = 1e-6;
-
-function clamp01(x) {
-  if (x < 0) return 0;
-  if (x > 1) return 1;
-  return x;
+rowsEl.textContent = String(maxRows);
+
+// The canvas is one pixel per bin and per row, scaled by CSS. Newest row at
+// the top; time goes downward.
+const canvas = document.getElementById("chart");
+const ctx = canvas.getContext("2d", { alpha: false });
+
+// Colour lookup table over v / colorMax in [0, 1], with the soft log curve
+// baked in so low values still show. Entries are packed RGBA for a Uint32Array
+// view of ImageData.
+const lutSize = 4096;
+const lut = new Uint32Array(lutSize);
+const littleEndian = new Uint8Array(new Uint32Array([1]).buffer)[0] === 1;
+
+function pack(r, g, b) {
+  return littleEndian
+    ? ((255 << 24) | (b << 16) | (g << 8) | r) >>> 0
+    : ((r << 24) | (g << 16) | (b << 8) | 255) >>> 0;
 }
 
 function hsvToRgb(h, s, v) {
@@ -35,131 +49,122 @@ function hsvToRgb(h, s, v) {
   else if (4 <= hp && hp < 5) [r, g, b] = [x, 0, c];
   else if (5 <= hp && hp < 6) [r, g, b] = [c, 0, x];
   const m = v - c;
-  r = Math.round((r + m) * 255);
-  g = Math.round((g + m) * 255);
-  b = Math.round((b + m) * 255);
-  return `rgb(${r},${g},${b})`;
+  return pack(Math.round((r + m) * 255), Math.round((g + m) * 255), Math.round((b + m) * 255));
 }
 
-function valueToColor(v) {
-  // Normalize using a soft log curve so low values still show.
-  // t in [0..1]
-  const t = clamp01(Math.log10(1 + 9 * (v / colorMax)) / Math.log10(10));
+for (let i = 0; i < lutSize; i++) {
+  const t = Math.log10(1 + 9 * (i / (lutSize - 1)));
   // Hue: 240 (blue) -> 0 (red)
-  const hue = (1 - t) * 240;
-  return hsvToRgb(hue, 1.0, 0.95);
+  lut[i] = hsvToRgb((1 - t) * 240, 1.0, 0.95);
 }
 
-function rebuildMatrixData() {
-  const data = [];
-  for (let y = 0; y < history.length; y++) {
-    const row = history[y];
-    for (let x = 0; x < nBins; x++) {
-      data.push({ x, y, v: row[x] ?? 0 });
-    }
-  }
-  return data;
-}
+// Auto scale for color mapping (simple peak-hold with decay). It applies to
+// rows as they arrive; rows already drawn keep their colours.
+let colorMax = 1e-6;
+let nBins = 0;
 
-const ctx = document.getElementById("chart").getContext("2d");
-const chart = new Chart(ctx, {
-  type: "matrix",
-  data: {
-    datasets: [
-      {
-        label: "Waterfall",
-        data: [],
-        backgroundColor: (c) => {
-          const v = c?.raw?.v ?? 0;
-          return valueToColor(v);
-        },
-        borderWidth: 0,
-        width: (c) => {
-          const a = c.chart.chartArea;
-          return a ? a.width / nBins : 10;
-        },
-        height: (c) => {
-          const a = c.chart.chartArea;
-          const rows = Math.max(1, maxRows);
-          return a ? a.height / rows : 4;
-        },
-      },
-    ],
-  },
-  options: {
-    responsive: true,
-    maintainAspectRatio: false,
-    animation: false,
-    plugins: {
-      legend: { display: false },
-      tooltip: { enabled: false },
-    },
-    scales: {
-      x: {
-        type: "linear",
-        min: -0.5,
-        max: nBins - 0.5,
-        grid: { display: false },
-        ticks: { display: false },
-      },
-      y: {
-        type: "linear",
-        min: -0.5,
-        max: maxRows - 0.5,
-        grid: { display: false },
-        ticks: { display: false },
-      },
-    },
-  },
-});
+// Rows received since the last paint, oldest first, in a ring of maxRows
+// packed rows. Frames can arrive faster than the display refreshes; each
+// animation frame paints all of them with one scroll and one putImageData.
+let pending = new Uint32Array(0);
+let pendingHead = 0; // next row to write
+let pendingCount = 0;
+let block = null; // ImageData the pending rows are copied into, newest first
+let blockPixels = null;
 
 function setStatus(s) {
   statusEl.textContent = s;
 }
 
+function resize(bins) {
+  nBins = bins;
+  binsEl.textContent = String(nBins);
+  canvas.width = nBins;
+  canvas.height = maxRows;
+  ctx.fillStyle = "#050813";
+  ctx.fillRect(0, 0, nBins, maxRows);
+
+  pending = new Uint32Array(maxRows * nBins);
+  pendingHead = 0;
+  pendingCount = 0;
+  block = ctx.createImageData(nBins, maxRows);
+  blockPixels = new Uint32Array(block.data.buffer);
+}
+
 function onBins(bins) {
-  if (!Array.isArray(bins)) return;
-  if (bins.length !== nBins) {
-    nBins = bins.length;
-    binsEl.textContent = String(nBins);
-    chart.options.scales.x.max = nBins - 0.5;
-  }
+  if (bins.length === 0) return;
+  if (bins.length !== nBins) resize(bins.length);
 
-  // Update color scale target.
-  const rowMax = bins.reduce((m, x) => Math.max(m, Number(x) || 0), 0);
+  let rowMax = 0;
+  for (let x = 0; x < nBins; x++) {
+    if (bins[x] > rowMax) rowMax = bins[x];
+  }
   colorMax = Math.max(colorMax * 0.98, rowMax, 1e-6);
 
-  history.push(bins.map((x) => Number(x) || 0));
-  const limit = Number.isFinite(maxRows) ? Math.max(1, maxRows) : 200;
-  while (history.length > limit) history.shift();
+  const scale = (lutSize - 1) / colorMax;
+  const offset = pendingHead * nBins;
+  for (let x = 0; x < nBins; x++) {
+    const v = bins[x] * scale;
+    // Comparisons also send NaN to the first entry.
+    pending[offset + x] = lut[v > 0 ? (v < lutSize - 1 ? v | 0 : lutSize - 1) : 0];
+  }
+  pendingHead = (pendingHead + 1) % maxRows;
+  pendingCount = Math.min(pendingCount + 1, maxRows);
+}
+
+function paint() {
+  requestAnimationFrame(paint);
+  if (pendingCount === 0) return;
+
+  const count = pendingCount;
+  for (let i = 0; i < count; i++) {
+    // i = 0 is the newest row.
+    const row = (pendingHead - 1 - i + maxRows) % maxRows;
+    blockPixels.set(pending.subarray(row * nBins, (row + 1) * nBins), i * nBins);
+  }
+  pendingCount = 0;
 
-  chart.data.datasets[0].data = rebuildMatrixData();
-  chart.update("none");
+  if (count < maxRows) ctx.drawImage(canvas, 0, 0, nBins, maxRows - count, 0, count, nBins, maxRows - count);
+  ctx.putImageData(block, 0, 0, 0, 0, nBins, count);
+}
+
+function onText(text) {
+  let msg;
+  try {
+    msg = JSON.parse(text);
+  } catch {
+    return;
+  }
+  if (msg.type === "meta") {
+    if (Number.isInteger(msg.logBins) && msg.logBins > 0 && msg.logBins !== nBins) resize(msg.logBins);
+    return;
+  }
+  if (Array.isArray(msg.bins)) onBins(Float32Array.from(msg.bins, (x) => Number(x) || 0));
 }
 
 function connect() {
   setStatus("connecting…");
-  const ws = new WebSocket(wsUrl);
+  const ws = new WebSocket(streamUrl);
+  ws.binaryType = "arraybuffer";
 
   ws.onopen = () => setStatus("connected");
   ws.onclose = () => {
-    setStatus("disconnected (reconnecting…)"); 
+    setStatus("disconnected (reconnecting…)");
     setTimeout(connect, 500);
   };
   ws.onerror = () => {
-    setStatus("error (reconnecting…)"); 
+    setStatus("error (reconnecting…)");
     try { ws.close(); } catch {}
   };
   ws.onmessage = (ev) => {
-    let msg;
-    try {
-      msg = JSON.parse(ev.data);
-    } catch {
-      return;
+    // Binary frames are the bins as native float32, nothing else.
+    if (ev.data instanceof ArrayBuffer) {
+      if (ev.data.byteLength % 4 === 0) onBins(new Float32Array(ev.data));
+    } else {
+      onText(ev.data);
     }
-    onBins(msg.bins);
   };
 }
 
 connect();
-
+requestAnimationFrame(paint);
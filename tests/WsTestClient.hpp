@@ -0,0 +1,80 @@
+#pragma once
+
+// Minimal blocking WebSocket client for the server tests.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Below the default ephemeral range (32768+), so a test server never finds its
+// port taken by the local end of some other connection.
+inline int testPort() { return 20000 + static_cast<int>(::getpid() % 12000); }
+
+// Connects and completes the WebSocket handshake; -1 on failure.
+inline int connectClient(int port, const std::string& target = "/") {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < until) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            const std::string req =
+                "GET " + target + " HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+            ::send(fd, req.data(), req.size(), MSG_NOSIGNAL);
+            char buf[512];
+            const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n > 0 && std::string(buf, static_cast<std::size_t>(n)).find("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != std::string::npos)
+                return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+// Sends one masked frame; payloads up to 125 bytes (no extended length).
+inline void sendMasked(int fd, std::uint8_t opcode, const std::string& payload) {
+    const std::uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    std::string frame;
+    frame.push_back(static_cast<char>(0x80 | opcode));
+    frame.push_back(static_cast<char>(0x80 | payload.size()));
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    for (std::size_t i = 0; i < payload.size(); ++i) frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    ::send(fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+}
+
+// Reads one unmasked server frame; returns its opcode, or -1 on error.
+inline int readFrame(int fd, std::string& payload) {
+    auto readExact = [fd](void* dst, std::size_t n) {
+        auto* p = static_cast<char*>(dst);
+        while (n > 0) {
+            const ssize_t r = ::recv(fd, p, n, 0);
+            if (r <= 0) return false;
+            p += r;
+            n -= static_cast<std::size_t>(r);
+        }
+        return true;
+    };
+    std::uint8_t head[2];
+    if (!readExact(head, 2)) return -1;
+    std::uint64_t len = head[1] & 0x7F;
+    if (len >= 126) {
+        std::uint8_t ext[8];
+        const std::size_t extLen = len == 126 ? 2 : 8;
+        if (!readExact(ext, extLen)) return -1;
+        len = 0;
+        for (std::size_t i = 0; i < extLen; ++i) len = (len << 8) | ext[i];
+    }
+    payload.resize(static_cast<std::size_t>(len));
+    if (len > 0 && !readExact(&payload[0], payload.size())) return -1;
+    return head[0] & 0x0F;
+}
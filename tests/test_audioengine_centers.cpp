@@ -20,7 +20,7 @@ TEST_CASE("AudioEngine::getLogBinCenters matches expected geometric centers") {
     CHECK(centers.front() >= 20.0f);
     CHECK(centers.back() <= static_cast<float>(sampleRate) * 0.5f + 1.0f);
 
-    // Exact expected centers using the same math as computeLogBinFreqs() + sqrt(lo*hi).
+    // Exact expected centers using the same math as LogBins::centers().
     std::vector<float> expected;
     expected.reserve(static_cast<std::size_t>(numBins));
 
@@ -0,0 +1,131 @@
+#include <doctest/doctest.h>
+
+#include "AudioEngine.hpp"
+#include "BatchSpectrogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+std::vector<float> testSignal(std::size_t count) {
+    std::vector<float> s(count);
+    for (std::size_t i = 0; i < count; ++i)
+        s[i] = 0.6f * std::sin(0.031f * float(i)) + 0.3f * std::sin(0.47f * float(i) + 0.2f * std::sin(0.0007f * float(i)));
+    return s;
+}
+
+// Reference: the recording pushed through a dynamic engine one hop at a time.
+std::vector<float> streamingFrames(const std::vector<float>& samples, int sampleRate,
+                                   const BatchSpectrogram::Options& options) {
+    AudioEngine engine(sampleRate, options.fftSize, options.logBins, "");
+    engine.startHosted();
+    const std::size_t hop = BatchSpectrogram::hopSamples(sampleRate, options.hopMs);
+    std::vector<float> out;
+    for (std::size_t pos = 0; pos + hop <= samples.size(); pos += hop) {
+        engine.pushSamples(samples.data() + pos, hop);
+        engine.runHop();
+        const auto bins = engine.getLogBins();
+        out.insert(out.end(), bins.begin(), bins.end());
+    }
+    engine.stop();
+    return out;
+}
+
+std::vector<float> batchFrames(const std::vector<float>& samples, int sampleRate,
+                               const BatchSpectrogram::Options& options,
+                               BatchSpectrogram::Result* result = nullptr) {
+    std::size_t pos = 0;
+    std::vector<float> out;
+    const auto r = BatchSpectrogram::run(
+        sampleRate,
+        [&](float* dst, std::size_t max) {
+            // Short reads, like a decoder delivering one block at a time.
+            const std::size_t count = std::min({max, samples.size() - pos, std::size_t(1000)});
+            std::copy(samples.begin() + long(pos), samples.begin() + long(pos + count), dst);
+            pos += count;
+            return count;
+        },
+        [&](const float* frames, std::size_t count) {
+            out.insert(out.end(), frames, frames + count * static_cast<std::size_t>(options.logBins));
+        },
+        options);
+    if (result) *result = r;
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("Batch spectrogram is bit-identical to the streaming engine (overlapping windows)") {
+    const int sampleRate = 44100;
+    const auto samples = testSignal(sampleRate * 3 + 123);
+    BatchSpectrogram::Options options;
+    options.fftSize = 2048;
+    options.logBins = 128;
+    options.hopMs = 10;
+    options.workers = 3;
+    options.framesPerChunk = 7;
+
+    BatchSpectrogram::Result result;
+    const auto batch = batchFrames(samples, sampleRate, options, &result);
+    const auto stream = streamingFrames(samples, sampleRate, options);
+    CHECK(result.frames == samples.size() / 441);
+    CHECK(result.audioSeconds == doctest::Approx(double(samples.size()) / sampleRate));
+    REQUIRE(batch.size() == stream.size());
+    CHECK(batch == stream);
+}
+
+TEST_CASE("Batch spectrogram is bit-identical to the streaming engine (hop longer than window)") {
+    const int sampleRate = 44100;
+    const auto samples = testSignal(sampleRate * 3 + 123);
+    BatchSpectrogram::Options options;
+    options.fftSize = 1024;
+    options.logBins = 64;
+    options.hopMs = 50;
+    options.workers = 2;
+    options.framesPerChunk = 5;
+
+    const auto batch = batchFrames(samples, sampleRate, options);
+    const auto stream = streamingFrames(samples, sampleRate, options);
+    REQUIRE(batch.size() == stream.size());
+    CHECK(batch == stream);
+}
+
+TEST_CASE("Batch spectrogram writes raw float32 frames and metadata") {
+    const int sampleRate = 48000;
+    const auto samples = testSignal(sampleRate);
+    const std::string path = "/tmp/batch_spectrogram_test_" + std::to_string(::getpid()) + ".f32";
+
+    BatchSpectrogram::Options options;
+    options.fftSize = 1024;
+    options.logBins = 64;
+    options.hopMs = 20;
+
+    BatchSpectrogram::Result result;
+    std::string error;
+    REQUIRE(BatchSpectrogram::processSamples(samples, sampleRate, path, options, &result, &error));
+    CHECK(result.frames == 50);
+
+    std::ifstream raw(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(raw)), std::istreambuf_iterator<char>());
+    REQUIRE(bytes.size() == 50 * 64 * sizeof(float));
+    std::vector<float> frames(50 * 64);
+    std::memcpy(frames.data(), bytes.data(), bytes.size());
+    CHECK(frames == batchFrames(samples, sampleRate, options));
+
+    std::ifstream metaFile(path + ".json");
+    const std::string meta((std::istreambuf_iterator<char>(metaFile)), std::istreambuf_iterator<char>());
+    CHECK(meta.find("\"type\":\"meta\"") != std::string::npos);
+    CHECK(meta.find("\"logBins\":64") != std::string::npos);
+
+    std::remove(path.c_str());
+    std::remove((path + ".json").c_str());
+}
@@ -0,0 +1,154 @@
+#include <doctest/doctest.h>
+
+#include "EngineHost.hpp"
+#include "JsonFormat.hpp"
+#include "WsTestClient.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Takes longer than its hop interval, so the host has to skip ticks.
+class SlowEngine final : public AudioEngine {
+public:
+    SlowEngine(std::chrono::milliseconds delay) : AudioEngine(44100, 1024, 64, ""), m_delay(delay) {}
+
+protected:
+    void processHop() override {
+        std::this_thread::sleep_for(m_delay);
+        AudioEngine::processHop();
+    }
+
+private:
+    std::chrono::milliseconds m_delay;
+};
+
+std::string expectedPrefix(const std::string& sourceId, const std::vector<float>& centers) {
+    return "{\"source\":" + jsonString(sourceId) + ",\"centers\":" + jsonArray(centers) + ",\"seq\":";
+}
+
+} // namespace
+
+TEST_CASE("EngineHost runs hops of all engines on a shared pool") {
+    EngineHost host(2);
+    CHECK(host.workerCount() == 2);
+
+    AudioEngine& tone = host.addEngine("tone", std::make_unique<AudioEngine>(44100, 1024, 64, ""), 10);
+    host.addEngine("silent-a", std::make_unique<AudioEngine>(44100, 1024, 64, ""), 10);
+    host.addEngine("silent-b", std::make_unique<AudioEngine>(48000, 2048, 128, ""), 20);
+
+    std::vector<float> sine(1024);
+    for (std::size_t i = 0; i < sine.size(); ++i)
+        sine[i] = std::sin(2.0f * 3.14159265f * 1000.0f * float(i) / 44100.0f);
+    tone.pushSamples(sine.data(), sine.size());
+
+    std::mutex mutex;
+    std::map<std::string, int> frames;
+    std::map<std::string, float> peak;
+    host.setFrameCallback([&](const std::string& id, const std::vector<float>& bins) {
+        std::lock_guard<std::mutex> lock(mutex);
+        frames[id]++;
+        for (float v : bins) peak[id] = std::max(peak[id], v);
+    });
+
+    host.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    host.stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(frames["tone"] > 3);
+    CHECK(frames["silent-a"] > 3);
+    CHECK(frames["silent-b"] > 1);
+    CHECK(peak["tone"] > 0.0f);
+    CHECK(peak["silent-a"] == 0.0f);
+
+    const auto stats = host.stats();
+    REQUIRE(stats.size() == 3);
+    for (const auto& s : stats) {
+        CHECK(s.hops == static_cast<std::uint64_t>(frames[s.sourceId]));
+    }
+}
+
+TEST_CASE("EngineHost tags WebSocket frames with their source and announces reconfigurations") {
+    const int port = testPort() + 8;
+    EngineHost host(2);
+    AudioEngine& a = host.addEngine("a", std::make_unique<AudioEngine>(44100, 1024, 64, ""), 10);
+    AudioEngine& b = host.addEngine("b", std::make_unique<AudioEngine>(48000, 2048, 128, ""), 10);
+    const std::string prefixA = expectedPrefix("a", a.getLogBinCenters());
+    const std::string prefixB = expectedPrefix("b", b.getLogBinCenters());
+    host.start(port);
+
+    const int fd = connectClient(port);
+    REQUIRE(fd >= 0);
+
+    std::string payload;
+    bool sawA = false, sawB = false;
+    for (int i = 0; i < 200 && !(sawA && sawB); ++i) {
+        REQUIRE(readFrame(fd, payload) == 0x1);
+        CHECK(payload.find(",\"ts\":") != std::string::npos);
+        const bool fromA = payload.rfind(prefixA, 0) == 0;
+        const bool fromB = payload.rfind(prefixB, 0) == 0;
+        CHECK((fromA || fromB));
+        sawA = sawA || fromA;
+        sawB = sawB || fromB;
+    }
+    CHECK(sawA);
+    CHECK(sawB);
+
+    REQUIRE(a.reconfigure(2048, 32));
+
+    // Frames of "a" keep the old centers until the meta message, and use the
+    // new ones from then on; "b" is unaffected.
+    bool sawMeta = false, sawNewA = false;
+    std::string newPrefixA;
+    for (int i = 0; i < 500 && !sawNewA; ++i) {
+        REQUIRE(readFrame(fd, payload) == 0x1);
+        if (payload.rfind("{\"type\":\"meta\"", 0) == 0) {
+            CHECK_FALSE(sawMeta);
+            sawMeta = true;
+            CHECK(payload.find("\"source\":\"a\"") != std::string::npos);
+            CHECK(payload.find("\"fftSize\":2048,\"logBins\":32,\"hopMs\":10") != std::string::npos);
+            newPrefixA = expectedPrefix("a", a.getLogBinCenters());
+            continue;
+        }
+        if (payload.rfind(prefixB, 0) == 0) continue;
+        if (!sawMeta) {
+            CHECK(payload.rfind(prefixA, 0) == 0);
+        } else {
+            CHECK(payload.rfind(newPrefixA, 0) == 0);
+            sawNewA = true;
+        }
+    }
+    CHECK(sawMeta);
+    CHECK(sawNewA);
+
+    ::close(fd);
+    host.stop();
+}
+
+TEST_CASE("EngineHost counts late and skipped hops") {
+    EngineHost host(1);
+    host.addEngine("slow", std::make_unique<SlowEngine>(std::chrono::milliseconds(25)), 10);
+    host.addEngine("fast", std::make_unique<AudioEngine>(44100, 1024, 64, ""), 50);
+
+    host.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    host.stop();
+
+    const auto stats = host.stats();
+    REQUIRE(stats.size() == 2);
+    const auto& slow = stats[0];
+    CHECK(slow.sourceId == "slow");
+    CHECK(slow.hops > 0);
+    // Each hop overruns its 10 ms deadline, and the ticks while it runs are skipped.
+    CHECK(slow.lateHops == slow.hops);
+    CHECK(slow.maxLatenessMs >= 10.0);
+    CHECK(slow.skippedHops >= slow.hops);
+    CHECK(stats[1].hops > 0);
+}
@@ -0,0 +1,92 @@
+#include <doctest/doctest.h>
+
+#include "Fft.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Reference DFT in double precision.
+std::vector<FftComplex> referenceDft(const std::vector<float>& x) {
+    const std::size_t n = x.size();
+    std::vector<FftComplex> out(n / 2 + 1);
+    for (std::size_t k = 0; k <= n / 2; ++k) {
+        double re = 0.0;
+        double im = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            const double ph = -2.0 * 3.14159265358979323846 * double(j * k) / double(n);
+            re += x[j] * std::cos(ph);
+            im += x[j] * std::sin(ph);
+        }
+        out[k] = FftComplex{float(re), float(im)};
+    }
+    return out;
+}
+
+void checkAgainstReference(int n) {
+    std::vector<float> x(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i)
+        x[static_cast<std::size_t>(i)] = std::sin(0.37f * i) + 0.25f * std::cos(1.9f * i);
+
+    RealFft fft(n);
+    std::vector<FftComplex> out(static_cast<std::size_t>(n / 2 + 1));
+    fft.forward(x.data(), out.data());
+
+    const auto ref = referenceDft(x);
+    for (std::size_t k = 0; k < ref.size(); ++k) {
+        CHECK(out[k].r == doctest::Approx(ref[k].r).epsilon(1e-3));
+        CHECK(out[k].i == doctest::Approx(ref[k].i).epsilon(1e-3));
+    }
+}
+
+} // namespace
+
+TEST_CASE("RealFft matches a reference DFT (power of two)") {
+    checkAgainstReference(64);
+}
+
+TEST_CASE("RealFft matches a reference DFT (non power of two)") {
+    checkAgainstReference(48);
+}
+
+TEST_CASE("RealFft puts a bin-centred tone into that bin") {
+    const int n = 1024;
+    const int k = 37;
+    std::vector<float> x(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i)
+        x[static_cast<std::size_t>(i)] = std::cos(2.0f * 3.14159265f * k * i / n);
+
+    RealFft fft(n);
+    std::vector<FftComplex> out(static_cast<std::size_t>(n / 2 + 1));
+    fft.forward(x.data(), out.data());
+
+    const float peak = std::hypot(out[k].r, out[k].i);
+    CHECK(peak == doctest::Approx(n / 2.0f).epsilon(1e-3));
+    CHECK(std::hypot(out[k + 3].r, out[k + 3].i) < 1e-2f * peak);
+}
+
+TEST_CASE("ComplexFft matches a reference DFT") {
+    for (int n : {8, 64, 256, 12}) {
+        std::vector<FftComplex> x(static_cast<std::size_t>(n));
+        for (int i = 0; i < n; ++i)
+            x[static_cast<std::size_t>(i)] = FftComplex{std::sin(0.37f * i), 0.5f * std::cos(1.1f * i)};
+
+        ComplexFft fft(n);
+        std::vector<FftComplex> out(x.size());
+        fft.forward(x.data(), out.data());
+
+        for (int k = 0; k < n; ++k) {
+            double re = 0.0;
+            double im = 0.0;
+            for (int j = 0; j < n; ++j) {
+                const double ph = -2.0 * 3.14159265358979323846 * double(j * k) / double(n);
+                const auto& v = x[static_cast<std::size_t>(j)];
+                re += v.r * std::cos(ph) - v.i * std::sin(ph);
+                im += v.r * std::sin(ph) + v.i * std::cos(ph);
+            }
+            CHECK(out[static_cast<std::size_t>(k)].r == doctest::Approx(re).epsilon(1e-3));
+            CHECK(out[static_cast<std::size_t>(k)].i == doctest::Approx(im).epsilon(1e-3));
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include <doctest/doctest.h>
+
+#include "FixedAudioEngine.hpp"
+#include "LogBins.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+template <int SampleRate, int FftSize, int Bins>
+void checkTablesMatchRuntime() {
+    using Kernel = dsp::FixedLogBinKernel<SampleRate, FftSize, Bins>;
+    const auto ranges = LogBins::ranges(SampleRate, FftSize, Bins, FftSize / 2);
+    REQUIRE(ranges.size() == static_cast<std::size_t>(Bins));
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        CHECK(Kernel::kTables.ranges[i].low == ranges[i].first);
+        CHECK(Kernel::kTables.ranges[i].high == ranges[i].second);
+    }
+    for (int i = 0; i < FftSize; ++i) {
+        CHECK(Kernel::kTables.window[static_cast<std::size_t>(i)] ==
+              doctest::Approx(dsp::hannWindow(i, FftSize)).epsilon(1e-6));
+    }
+}
+
+template <int SampleRate, int FftSize, int Bins>
+void checkKernelMatchesDynamicChain() {
+    std::vector<float> ring(static_cast<std::size_t>(FftSize));
+    for (std::size_t i = 0; i < ring.size(); ++i)
+        ring[i] = 0.5f * std::sin(0.07f * float(i)) + 0.2f * std::sin(1.1f * float(i));
+    const dsp::RingView view{ring.data(), ring.size(), 123};
+
+    dsp::LogBinChain chain;
+    chain.prepare(dsp::Config{SampleRate, FftSize, Bins});
+    const auto expected = chain.run(view);
+
+    dsp::FixedLogBinKernel<SampleRate, FftSize, Bins> kernel;
+    const auto& got = kernel.run(view);
+
+    REQUIRE(got.size() == expected.size());
+    for (std::size_t i = 0; i < got.size(); ++i)
+        CHECK(got[i] == doctest::Approx(expected[i]).epsilon(1e-4));
+}
+
+template <int Size>
+void checkFixedFftMatchesRuntime() {
+    std::vector<float> in(static_cast<std::size_t>(Size));
+    for (std::size_t i = 0; i < in.size(); ++i)
+        in[i] = 0.7f * std::sin(0.3f * float(i)) + 0.2f * std::cos(2.1f * float(i)) + (i % 7 == 0 ? 0.5f : 0.0f);
+
+    std::vector<FftComplex> expected(static_cast<std::size_t>(Size / 2 + 1));
+    std::vector<FftComplex> got(expected.size());
+    RealFft(Size).forward(in.data(), expected.data());
+    dsp::FixedRealFft<Size> fft;
+    fft.forward(in.data(), got.data());
+
+    // Errors scale with the sum of |input|, which bounds every bin.
+    float scale = 0.0f;
+    for (float x : in) scale += std::fabs(x);
+    for (std::size_t k = 0; k < got.size(); ++k) {
+        CHECK(std::fabs(got[k].r - expected[k].r) <= 1e-5f * scale);
+        CHECK(std::fabs(got[k].i - expected[k].i) <= 1e-5f * scale);
+    }
+}
+
+} // namespace
+
+TEST_CASE("FixedRealFft matches RealFft") {
+    checkFixedFftMatchesRuntime<4>();
+    checkFixedFftMatchesRuntime<8>();
+    checkFixedFftMatchesRuntime<1024>();
+    checkFixedFftMatchesRuntime<4096>();
+}
+
+TEST_CASE("Compile-time tables match the runtime log-bin ranges and window") {
+    checkTablesMatchRuntime<44100, 1024, 64>();
+    checkTablesMatchRuntime<44100, 2048, 128>();
+    checkTablesMatchRuntime<44100, 4096, 128>();
+    checkTablesMatchRuntime<48000, 1024, 64>();
+    checkTablesMatchRuntime<48000, 2048, 128>();
+    checkTablesMatchRuntime<48000, 4096, 128>();
+}
+
+TEST_CASE("FixedLogBinKernel matches the dynamic LogBinChain") {
+    checkKernelMatchesDynamicChain<44100, 1024, 64>();
+    checkKernelMatchesDynamicChain<48000, 2048, 128>();
+}
+
+TEST_CASE("FixedAudioEngine shares the AudioEngine interface") {
+    FixedAudioEngine1024x64 fixed;
+    AudioEngine dynamic(44100, 1024, 64, "");
+    AudioEngine& engine = fixed;
+
+    CHECK(engine.getLogBinCenters() == dynamic.getLogBinCenters());
+    CHECK(engine.getLogBins().size() == 64);
+}
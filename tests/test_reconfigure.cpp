@@ -0,0 +1,107 @@
+#include <doctest/doctest.h>
+
+#include "AudioEngine.hpp"
+#include "FixedAudioEngine.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Exposes the capture ring so tests can check nothing was dropped.
+class ProbeEngine final : public AudioEngine {
+public:
+    using AudioEngine::AudioEngine;
+    ~ProbeEngine() override { stop(); }
+
+    std::vector<float> chronologicalRing() {
+        std::lock_guard<std::mutex> lock(captureMutex);
+        const auto v = captureView();
+        std::vector<float> out(v.size);
+        for (std::size_t i = 0; i < v.size; ++i) out[i] = v.data[(v.writeIdx + i) % v.size];
+        return out;
+    }
+};
+
+bool hopUntilVersion(AudioEngine& engine, std::uint64_t version) {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (engine.getConfigVersion() < version) {
+        if (std::chrono::steady_clock::now() > until) return false;
+        engine.runHop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("reconfigure swaps plan between hops without losing captured samples") {
+    ProbeEngine engine(44100, 1024, 64, "");
+    engine.startHosted();
+
+    std::vector<float> ramp(1500);
+    for (std::size_t i = 0; i < ramp.size(); ++i) ramp[i] = float(i);
+    engine.pushSamples(ramp.data(), ramp.size());
+
+    engine.runHop();
+    CHECK(engine.getLogBins().size() == 64);
+
+    int callbacks = 0;
+    AudioEngine::Info seen{};
+    engine.setReconfigureCallback([&](const AudioEngine::Info& info) {
+        ++callbacks;
+        seen = info;
+    });
+
+    REQUIRE(engine.reconfigure(4096, 128, 20));
+    REQUIRE(hopUntilVersion(engine, 1));
+
+    CHECK(callbacks == 1);
+    CHECK(seen.fftSize == 4096);
+    CHECK(seen.logBins == 128);
+    CHECK(seen.hopMs == 20);
+    CHECK(seen.centers.size() == 128);
+    CHECK(engine.getLogBins().size() == 128);
+    CHECK(engine.getLogBinCenters() == seen.centers);
+
+    // The ring grew; the last 1024 samples are still there, newest last.
+    const auto ring = engine.chronologicalRing();
+    REQUIRE(ring.size() == 4096);
+    for (std::size_t i = 0; i < 1024; ++i) CHECK(ring[4096 - 1024 + i] == float(1500 - 1024 + i));
+
+    // Capture continues seamlessly after the swap.
+    std::vector<float> more{1500.0f, 1501.0f};
+    engine.pushSamples(more.data(), more.size());
+    const auto after = engine.chronologicalRing();
+    CHECK(after[4095] == 1501.0f);
+    CHECK(after[4094] == 1500.0f);
+    CHECK(after[4093] == 1499.0f);
+
+    // Shrinking keeps the larger ring.
+    REQUIRE(engine.reconfigure(512, 32, 50));
+    REQUIRE(hopUntilVersion(engine, 2));
+    CHECK(engine.getLogBins().size() == 32);
+    CHECK(engine.chronologicalRing().size() == 4096);
+
+    engine.stop();
+}
+
+TEST_CASE("reconfigure rejects invalid requests and fixed engines") {
+    AudioEngine engine(44100, 1024, 64, "");
+    CHECK_FALSE(engine.reconfigure(0, 64, 50));
+    CHECK_FALSE(engine.reconfigure(1024, 0, 50));
+    CHECK_FALSE(engine.reconfigure(1024, 64, 0));
+    CHECK_FALSE(engine.reconfigure(1023, 64, 50));
+    CHECK_FALSE(engine.reconfigure(1536, 64, 50));
+    CHECK_FALSE(engine.reconfigure(32, 64, 50));
+    CHECK_FALSE(engine.reconfigure(AudioEngine::kMaxFftSize * 2, 64, 50));
+    CHECK_FALSE(engine.reconfigure(1024, AudioEngine::kMaxLogBins + 1, 50));
+    CHECK_FALSE(engine.reconfigure(1024, 64, AudioEngine::kMaxHopMs + 1));
+    CHECK(engine.getConfigVersion() == 0);
+
+    FixedAudioEngine1024x64 fixed;
+    CHECK_FALSE(fixed.reconfigure(2048, 128, 50));
+    CHECK(fixed.getInfo().fftSize == 1024);
+}
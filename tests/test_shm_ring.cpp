@@ -0,0 +1,157 @@
+#include <doctest/doctest.h>
+
+#include "AudioEngine.hpp"
+#include "ShmFrameReader.hpp"
+#include "ShmFrameRing.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+std::string uniqueName(const char* tag) {
+    return std::string("/aetest-") + tag + "-" + std::to_string(::getpid());
+}
+
+float expectedBin(std::uint64_t seq, std::size_t i) { return float(seq) + 0.25f * float(i); }
+
+// Consumer process: follows the ring and checks every frame it manages to read.
+int runConsumer(const std::string& name, std::uint64_t lastSeq) {
+    ShmFrameReader reader;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!reader.open(name)) {
+        if (std::chrono::steady_clock::now() > until) return 2;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (reader.binCount() != 32 || reader.sampleRate() != 48000 || reader.fftSize() != 2048) return 3;
+    if (reader.centers()[5] != 105.0f) return 4;
+
+    std::uint64_t next = 0;
+    std::uint64_t okFrames = 0;
+    while (next <= lastSeq) {
+        if (std::chrono::steady_clock::now() > until) return 5;
+
+        bool consistent = true;
+        const auto st = reader.read(next, [&](const ShmFrameReader::FrameView& f) {
+            for (std::uint32_t i = 0; i < f.binCount; ++i)
+                if (f.bins[i] != expectedBin(f.seq, i)) consistent = false;
+        });
+
+        if (st == ShmFrameReader::ReadStatus::Ok) {
+            if (!consistent) return 6; // a validated read must never be torn
+            ++okFrames;
+            ++next;
+        } else if (st == ShmFrameReader::ReadStatus::Overwritten) {
+            next = reader.oldestAvailable();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return okFrames > 0 ? 0 : 7;
+}
+
+} // namespace
+
+TEST_CASE("Shared-memory ring: producer and consumer in separate processes") {
+    const std::string name = uniqueName("xproc");
+    const std::uint64_t frames = 20000;
+
+    const pid_t child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0) ::_exit(runConsumer(name, frames - 1));
+
+    std::vector<float> centers(32);
+    for (std::size_t i = 0; i < centers.size(); ++i) centers[i] = 100.0f + float(i);
+
+    ShmFrameRing ring;
+    std::string error;
+    REQUIRE(ring.create(name, 64, 48000, 2048, centers, &error));
+
+    std::vector<float> bins(32);
+    for (std::uint64_t seq = 0; seq < frames; ++seq) {
+        for (std::size_t i = 0; i < bins.size(); ++i) bins[i] = expectedBin(seq, i);
+        ring.publish(bins.data(), bins.size(), static_cast<std::int64_t>(seq));
+        if (seq % 64 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    int status = 0;
+    REQUIRE(::waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    ring.close();
+}
+
+TEST_CASE("Shared-memory ring reports unwritten, overwritten and retired frames") {
+    const std::string name = uniqueName("status");
+    std::vector<float> centers{1.0f, 2.0f, 3.0f};
+
+    ShmFrameRing ring;
+    REQUIRE(ring.create(name, 4, 44100, 1024, centers));
+
+    ShmFrameReader reader;
+    REQUIRE(reader.open(name));
+    std::vector<float> out;
+    CHECK(reader.copy(0, out) == ShmFrameReader::ReadStatus::NotYetWritten);
+
+    const float f[3] = {7.0f, 8.0f, 9.0f};
+    for (int i = 0; i < 6; ++i) ring.publish(f, 3, i);
+
+    CHECK(reader.published() == 6);
+    CHECK(reader.copy(0, out) == ShmFrameReader::ReadStatus::Overwritten);
+    std::int64_t ts = -1;
+    CHECK(reader.copy(5, out, &ts) == ShmFrameReader::ReadStatus::Ok);
+    CHECK(ts == 5);
+    CHECK(out == std::vector<float>{7.0f, 8.0f, 9.0f});
+
+    CHECK_FALSE(reader.retired());
+    ring.close();
+    CHECK(reader.retired());
+}
+
+TEST_CASE("AudioEngine publishes frames into shared memory and follows reconfigure") {
+    const std::string name = uniqueName("engine");
+    AudioEngine engine(44100, 1024, 64, "");
+    REQUIRE(engine.enableSharedMemory(name, 16));
+    engine.startHosted();
+    engine.runHop();
+    engine.runHop();
+
+    ShmFrameReader reader;
+    REQUIRE(reader.open(name));
+    CHECK(reader.binCount() == 64);
+    CHECK(reader.published() == 2);
+    CHECK(reader.centers()[10] == engine.getLogBinCenters()[10]);
+
+    REQUIRE(engine.reconfigure(2048, 128, 50));
+    // The new ring is created by the plan builder, before any hop adopts it,
+    // while the old one keeps being served.
+    ShmFrameReader next;
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!(next.open(name) && next.binCount() == 128) && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE(next.binCount() == 128);
+    CHECK(next.published() == 0);
+    CHECK_FALSE(reader.retired());
+    CHECK(engine.getConfigVersion() == 0);
+
+    until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (engine.getConfigVersion() == 0 && std::chrono::steady_clock::now() < until) {
+        engine.runHop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    engine.runHop();
+
+    CHECK(reader.retired());
+    CHECK_FALSE(next.retired());
+    CHECK(next.published() >= 1);
+    REQUIRE(reader.open(name));
+    CHECK(reader.binCount() == 128);
+    CHECK(reader.published() >= 1);
+    engine.stop();
+}
@@ -0,0 +1,110 @@
+#include <doctest/doctest.h>
+
+#include "AudioEngine.hpp"
+#include "ThreadTuning.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+TEST_CASE("Default ThreadPolicy is a no-op") {
+    std::string error;
+    CHECK(thread_tuning::applyToCurrentThread(ThreadPolicy{}, &error));
+    CHECK(error.empty());
+}
+
+#if defined(__linux__)
+TEST_CASE("ThreadPolicy pins the calling thread") {
+    // Any CPU this process may run on; CPU 0 can be outside the cpuset.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    REQUIRE(sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    int cpu = -1;
+    for (int c = CPU_SETSIZE - 1; c >= 0; --c)
+        if (CPU_ISSET(c, &allowed)) cpu = c;
+    REQUIRE(cpu >= 0);
+
+    std::thread t([cpu] {
+        ThreadPolicy policy;
+        policy.cpus = {cpu};
+        std::string error;
+        CHECK(thread_tuning::applyToCurrentThread(policy, &error));
+        CHECK(error.empty());
+        CHECK(sched_getcpu() == cpu);
+    });
+    t.join();
+}
+
+TEST_CASE("Real-time scheduling either applies or explains why not") {
+    std::thread t([] {
+        ThreadPolicy policy;
+        policy.scheduling = ThreadPolicy::Scheduling::Fifo;
+        policy.priority = 10;
+        std::string error;
+        const bool ok = thread_tuning::applyToCurrentThread(policy, &error);
+        if (ok) CHECK(sched_getscheduler(0) == SCHED_FIFO);
+        else CHECK(!error.empty());
+    });
+    t.join();
+}
+#endif
+
+TEST_CASE("prefault touches buffers without changing them") {
+    std::vector<float> buf(10000, 1.5f);
+    thread_tuning::prefault(buf.data(), buf.size() * sizeof(float));
+    CHECK(buf.front() == 1.5f);
+    CHECK(buf.back() == 1.5f);
+}
+
+TEST_CASE("AudioEngine records hop latencies and real-time warnings") {
+    // lockMemory is process-wide; undo it so the rest of this test binary
+    // does not run with every page locked.
+    struct UnlockOnExit {
+        ~UnlockOnExit() { thread_tuning::unlockProcessMemory(); }
+    } unlock;
+
+    // What this process may do decides which warnings to expect.
+    bool realtimeAllowed = false;
+    std::thread probe([&] {
+        ThreadPolicy policy;
+        policy.scheduling = ThreadPolicy::Scheduling::RoundRobin;
+        policy.priority = 10;
+        realtimeAllowed = thread_tuning::applyToCurrentThread(policy);
+    });
+    probe.join();
+    const bool lockAllowed = thread_tuning::lockProcessMemory();
+    thread_tuning::unlockProcessMemory();
+
+    AudioEngine engine(44100, 1024, 64, "");
+
+    AudioEngine::RealtimeOptions options;
+    options.analysis.scheduling = ThreadPolicy::Scheduling::RoundRobin;
+    options.analysis.priority = 10;
+    options.lockMemory = true;
+    engine.setRealtimeOptions(options);
+
+    CHECK(engine.reconfigure(1024, 64, 5));
+    engine.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    engine.stop();
+
+    const auto latencies = engine.getHopLatenciesUs();
+    CHECK(latencies.size() > 5);
+    for (float us : latencies) CHECK(us >= 0.0f);
+
+    // Without privileges the options degrade to warnings, never to failure.
+    const auto warnings = engine.getRealtimeWarnings();
+    auto hasWarning = [&](const std::string& prefix) {
+        return std::any_of(warnings.begin(), warnings.end(),
+                           [&](const std::string& w) { return w.rfind(prefix, 0) == 0; });
+    };
+    CHECK(hasWarning("analysis thread: ") == !realtimeAllowed);
+    CHECK(hasWarning("mlockall") == !lockAllowed);
+    CHECK(warnings.size() == std::size_t(realtimeAllowed ? 0 : 1) + std::size_t(lockAllowed ? 0 : 1));
+}
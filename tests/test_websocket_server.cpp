@@ -0,0 +1,441 @@
+#include <doctest/doctest.h>
+
+#include "JsonFormat.hpp"
+#include "WebSocketServer.hpp"
+#include "WsTestClient.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+TEST_CASE("WebSocketServer sends binary frames to clients that ask for them") {
+    const int port = testPort() + 2;
+    WebSocketServer server(port);
+    const std::vector<float> bins = {0.0f, 1.5f, -2.0f, 1e-3f};
+    server.setBinaryProvider([&]() {
+        return std::string(reinterpret_cast<const char*>(bins.data()), bins.size() * sizeof(float));
+    });
+    server.start([]() { return std::string("{\"bins\":[0,1.5,-2,0.001]}"); }, 10);
+
+    const int text = connectClient(port);
+    const int binary = connectClient(port, "/?v=1&format=binary");
+    REQUIRE(text >= 0);
+    REQUIRE(binary >= 0);
+    server.broadcast("{\"type\":\"meta\"}");
+
+    // The binary client sees the queued text message and raw float32 frames,
+    // never the provider's JSON.
+    std::string payload;
+    bool sawMeta = false;
+    for (int i = 0; i < 20; ++i) {
+        const int opcode = readFrame(binary, payload);
+        REQUIRE(opcode > 0);
+        if (opcode == 0x1) {
+            CHECK(payload == "{\"type\":\"meta\"}");
+            sawMeta = true;
+            continue;
+        }
+        CHECK(opcode == 0x2);
+        REQUIRE(payload.size() == bins.size() * sizeof(float));
+        std::vector<float> decoded(bins.size());
+        std::memcpy(decoded.data(), payload.data(), payload.size());
+        CHECK(decoded == bins);
+    }
+    CHECK(sawMeta);
+
+    for (int i = 0; i < 20; ++i) {
+        const int opcode = readFrame(text, payload);
+        CHECK(opcode == 0x1);
+        CHECK((payload == "{\"type\":\"meta\"}" || payload.rfind("{\"bins\":", 0) == 0));
+    }
+
+    ::close(text);
+    ::close(binary);
+    server.stop();
+}
+
+TEST_CASE("WebSocketServer drops a closing client and keeps serving the others") {
+    const int port = testPort() + 3;
+    WebSocketServer server(port);
+    server.start([]() { return std::string("{\"bins\":[]}"); }, 10);
+
+    const int leaving = connectClient(port);
+    const int staying = connectClient(port);
+    REQUIRE(leaving >= 0);
+    REQUIRE(staying >= 0);
+    sendMasked(leaving, 0x8, "");
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server.clientCount() != 1 && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK(server.clientCount() == 1);
+
+    // New clients (which may reuse descriptor numbers) are served normally.
+    const int next = connectClient(port);
+    REQUIRE(next >= 0);
+    std::string payload;
+    CHECK(readFrame(next, payload) == 0x1);
+    CHECK(readFrame(staying, payload) == 0x1);
+    CHECK(payload == "{\"bins\":[]}");
+
+    ::close(leaving);
+    ::close(staying);
+    ::close(next);
+    server.stop();
+}
+
+TEST_CASE("WebSocketServer does not let a client that stops reading hold up the others") {
+    const int port = testPort() + 4;
+    WebSocketServer server(port);
+    server.start();
+
+    const int stuck = connectClient(port);
+    const int reader = connectClient(port);
+    REQUIRE(stuck >= 0);
+    REQUIRE(reader >= 0);
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server.clientCount() != 2 && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // Far more than the socket buffers of the client that never reads.
+    const std::string block(64 * 1024, 'x');
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 500; ++i) server.broadcast(block);
+    server.broadcast("last");
+
+    std::string payload;
+    int frames = 0;
+    while (readFrame(reader, payload) == 0x1 && payload != "last") ++frames;
+    CHECK(payload == "last");
+    CHECK(frames > 0);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    CHECK(server.clientCount() == 2);
+
+    ::close(stuck);
+    ::close(reader);
+    server.stop();
+}
+
+TEST_CASE("WebSocketServer accepts new clients while another connection sends nothing") {
+    const int port = testPort() + 7;
+    WebSocketServer server(port);
+    server.start();
+
+    const int first = connectClient(port);
+    REQUIRE(first >= 0);
+
+    // Connected, but never sends a request.
+    const int silent = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(::connect(silent, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    const auto start = std::chrono::steady_clock::now();
+    const int second = connectClient(port);
+    CHECK(second >= 0);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+
+    ::close(first);
+    ::close(second);
+    ::close(silent);
+    server.stop();
+}
+
+TEST_CASE("WebSocketServer passes client text messages to the handler") {
+    const int port = testPort();
+    WebSocketServer server(port);
+
+    std::mutex mutex;
+    std::vector<std::string> received;
+    server.setMessageHandler([&](const std::string& text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(text);
+    });
+    server.start();
+
+    const int fd = connectClient(port);
+    REQUIRE(fd >= 0);
+    sendMasked(fd, 0x9, "ping");
+    sendMasked(fd, 0x1, "{\"type\":\"zoom\",\"lowHz\":50,\"highHz\":70.5}");
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!received.empty() || std::chrono::steady_clock::now() > until) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(received.size() == 1);
+        std::string type;
+        double low = 0.0, high = 0.0;
+        CHECK(jsonStringField(received[0], "type", type));
+        CHECK(type == "zoom");
+        CHECK(jsonNumberField(received[0], "lowHz", low));
+        CHECK(jsonNumberField(received[0], "highHz", high));
+        CHECK(low == 50.0);
+        CHECK(high == 70.5);
+        CHECK_FALSE(jsonNumberField(received[0], "fftSize", low));
+    }
+
+    ::close(fd);
+    server.stop();
+}
+
+TEST_CASE("WebSocketServer keeps a frame sent right behind the upgrade request") {
+    const int port = testPort() + 5;
+    WebSocketServer server(port);
+
+    std::mutex mutex;
+    std::vector<std::string> received;
+    server.setMessageHandler([&](const std::string& text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(text);
+    });
+    server.start();
+
+    // Handshake and first frame in one segment, before the 101 is read.
+    const std::uint8_t mask[4] = {1, 2, 3, 4};
+    const std::string payload = "{\"type\":\"zoom\"}";
+    std::string frame = "\x81";
+    frame.push_back(static_cast<char>(0x80 | payload.size()));
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    for (std::size_t i = 0; i < payload.size(); ++i) frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    const std::string req =
+        "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n" + frame;
+
+    int fd = -1;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < until) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) break;
+        ::close(fd);
+        fd = -1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(fd >= 0);
+    ::send(fd, req.data(), req.size(), MSG_NOSIGNAL);
+
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!received.empty() || std::chrono::steady_clock::now() > until) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(received.size() == 1);
+        CHECK(received[0] == payload);
+    }
+
+    ::close(fd);
+    server.stop();
+}
+
+namespace {
+
+struct HttpResponse {
+    int status = 0;
+    std::string head;
+    std::string body;
+
+    std::string header(const std::string& name) const {
+        const std::size_t pos = head.find("\r\n" + name + ": ");
+        if (pos == std::string::npos) return {};
+        const std::size_t begin = pos + name.size() + 4;
+        return head.substr(begin, head.find("\r\n", begin) - begin);
+    }
+};
+
+int connectPlain(int port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends one request and reads one response (Content-Length framed).
+HttpResponse request(int fd, const std::string& req, bool headRequest = false) {
+    ::send(fd, req.data(), req.size(), MSG_NOSIGNAL);
+    HttpResponse r;
+    std::string data;
+    char buf[4096];
+    std::size_t headEnd = std::string::npos;
+    std::size_t length = 0;
+    for (;;) {
+        if (headEnd == std::string::npos && (headEnd = data.find("\r\n\r\n")) != std::string::npos) {
+            r.head = data.substr(0, headEnd + 2);
+            r.status = std::atoi(r.head.c_str() + 9);
+            const std::string cl = r.header("Content-Length");
+            length = (headRequest || cl.empty()) ? 0 : std::stoul(cl);
+        }
+        if (headEnd != std::string::npos && data.size() >= headEnd + 4 + length) break;
+        const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        data.append(buf, static_cast<std::size_t>(n));
+    }
+    if (headEnd != std::string::npos) r.body = data.substr(headEnd + 4, length);
+    return r;
+}
+
+std::string get(const std::string& path, const std::string& extra = {}) {
+    return "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n" + extra + "\r\n";
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    REQUIRE(f != nullptr);
+    std::fwrite(content.data(), 1, content.size(), f);
+    std::fclose(f);
+}
+
+} // namespace
+
+TEST_CASE("WebSocketServer serves static files next to the WebSocket endpoint") {
+    char dirTemplate[] = "/tmp/ws_static_XXXXXX";
+    REQUIRE(::mkdtemp(dirTemplate) != nullptr);
+    const std::string dir = dirTemplate;
+    REQUIRE(::mkdir((dir + "/sub").c_str(), 0755) == 0);
+    writeFile(dir + "/index.html", "<html>hello</html>");
+    writeFile(dir + "/app.js", "console.log('plain');");
+    writeFile(dir + "/app.js.gz", "GZIPPED-BYTES");
+    writeFile(dir + "/sub/index.html", "sub");
+
+    const int port = testPort() + 1;
+    WebSocketServer server(port);
+    CHECK_FALSE(server.setStaticRoot(dir + "/missing"));
+    REQUIRE(server.setStaticRoot(dir));
+    server.start();
+
+    int fd = -1;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((fd = connectPlain(port)) < 0 && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(fd >= 0);
+
+    // Several requests on one kept-alive connection.
+    const auto index = request(fd, get("/"));
+    CHECK(index.status == 200);
+    CHECK(index.body == "<html>hello</html>");
+    CHECK(index.header("Content-Type") == "text/html; charset=utf-8");
+    CHECK(index.header("Connection") == "keep-alive");
+    const std::string etag = index.header("ETag");
+    CHECK(!etag.empty());
+
+    const auto notModified = request(fd, get("/index.html", "If-None-Match: W/\"x\", " + etag + "\r\n"));
+    CHECK(notModified.status == 304);
+    CHECK(notModified.body.empty());
+
+    const auto plain = request(fd, get("/app.js?v=1"));
+    CHECK(plain.status == 200);
+    CHECK(plain.body == "console.log('plain');");
+    CHECK(plain.header("Content-Encoding").empty());
+
+    const auto gz = request(fd, get("/app.js", "Accept-Encoding: br;q=0, gzip\r\n"));
+    CHECK(gz.status == 200);
+    CHECK(gz.body == "GZIPPED-BYTES");
+    CHECK(gz.header("Content-Encoding") == "gzip");
+    CHECK(gz.header("Content-Type") == "text/javascript; charset=utf-8");
+    CHECK(gz.header("ETag") != plain.header("ETag"));
+
+    const auto head = request(fd, "HEAD /app.js HTTP/1.1\r\nHost: localhost\r\n\r\n", true);
+    CHECK(head.status == 200);
+    CHECK(head.header("Content-Length") == "21");
+    CHECK(head.body.empty());
+
+    CHECK(request(fd, get("/sub")).header("Location") == "/sub/");
+    CHECK(request(fd, get("/sub/")).body == "sub");
+    CHECK(request(fd, get("/missing.js")).status == 404);
+    CHECK(request(fd, get("/../etc/passwd")).status == 403);
+    CHECK(request(fd, get("/%2e%2e/etc/passwd")).status == 403);
+
+    const auto closing = request(fd, get("/", "Connection: close\r\n"));
+    CHECK(closing.status == 200);
+    CHECK(closing.header("Connection") == "close");
+    ::close(fd);
+
+    fd = connectPlain(port);
+    REQUIRE(fd >= 0);
+    CHECK(request(fd, "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 0\r\n\r\n").status == 405);
+    ::close(fd);
+
+    // WebSocket upgrades still work on the same port.
+    const int ws = connectClient(port);
+    CHECK(ws >= 0);
+    if (ws >= 0) ::close(ws);
+
+    server.stop();
+    for (const char* f : {"/index.html", "/app.js", "/app.js.gz", "/sub/index.html"}) std::remove((dir + f).c_str());
+    ::rmdir((dir + "/sub").c_str());
+    ::rmdir(dir.c_str());
+}
+
+TEST_CASE("WebSocketServer does not let a slow static file client hold up other page loads") {
+    char dirTemplate[] = "/tmp/ws_static_XXXXXX";
+    REQUIRE(::mkdtemp(dirTemplate) != nullptr);
+    const std::string dir = dirTemplate;
+    writeFile(dir + "/big.bin", std::string(32 * 1024 * 1024, 'b'));
+    writeFile(dir + "/index.html", "<html>hello</html>");
+
+    const int port = testPort() + 6;
+    WebSocketServer server(port);
+    REQUIRE(server.setStaticRoot(dir));
+    server.start();
+
+    int stalled = -1;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((stalled = connectPlain(port)) < 0 && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(stalled >= 0);
+    // Asks for far more than the socket buffers hold and never reads it.
+    const std::string big = get("/big.bin");
+    ::send(stalled, big.data(), big.size(), MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const int fd = connectPlain(port);
+    REQUIRE(fd >= 0);
+    timeval timeout{3, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    const auto start = std::chrono::steady_clock::now();
+    const auto index = request(fd, get("/"));
+    CHECK(index.status == 200);
+    CHECK(index.body == "<html>hello</html>");
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+    ::close(fd);
+    ::close(stalled);
+    server.stop();
+    for (const char* f : {"/big.bin", "/index.html"}) std::remove((dir + f).c_str());
+    ::rmdir(dir.c_str());
+}
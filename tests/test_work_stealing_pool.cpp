@@ -0,0 +1,52 @@
+#include <doctest/doctest.h>
+
+#include "WorkStealingPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+bool waitFor(const std::atomic<int>& counter, int target) {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (counter.load() < target) {
+        if (std::chrono::steady_clock::now() > until) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("WorkStealingPool runs every submitted task") {
+    WorkStealingPool pool(4);
+    CHECK(pool.size() == 4);
+
+    std::atomic<int> done{0};
+    for (int i = 0; i < 1000; ++i) pool.submit([&done] { done.fetch_add(1); });
+
+    CHECK(waitFor(done, 1000));
+}
+
+TEST_CASE("WorkStealingPool runs tasks submitted from workers") {
+    WorkStealingPool pool(2);
+
+    std::atomic<int> done{0};
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([&pool, &done] {
+            for (int j = 0; j < 10; ++j) pool.submit([&done] { done.fetch_add(1); });
+        });
+    }
+
+    CHECK(waitFor(done, 100));
+}
+
+TEST_CASE("WorkStealingPool destructor drains pending tasks") {
+    std::atomic<int> done{0};
+    {
+        WorkStealingPool pool(1);
+        for (int i = 0; i < 50; ++i) pool.submit([&done] { done.fetch_add(1); });
+    }
+    CHECK(done.load() == 50);
+}
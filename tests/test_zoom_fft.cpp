@@ -0,0 +1,145 @@
+#include <doctest/doctest.h>
+
+#include "AudioEngine.hpp"
+#include "ZoomFft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> tones(int sampleRate, double seconds, std::vector<double> freqs) {
+    std::vector<float> s(static_cast<std::size_t>(sampleRate * seconds));
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        double v = 0.0;
+        for (double f : freqs) v += 0.5 * std::sin(2.0 * kPi * f * double(i) / sampleRate);
+        s[i] = static_cast<float>(v);
+    }
+    return s;
+}
+
+// Push in capture-callback sized blocks.
+void feed(dsp::ZoomAnalyzer& z, const std::vector<float>& s) {
+    for (std::size_t pos = 0; pos < s.size(); pos += 256)
+        z.push(s.data() + pos, std::min<std::size_t>(256, s.size() - pos));
+}
+
+float peakHz(const dsp::ZoomAnalyzer& z, const std::vector<float>& bins) {
+    const auto it = std::max_element(bins.begin(), bins.end());
+    return z.startHz() + z.binHz() * float(it - bins.begin());
+}
+
+} // namespace
+
+TEST_CASE("Zoom FFT resolves a narrow band at sub-hertz resolution") {
+    const int sr = 44100;
+    dsp::ZoomAnalyzer zoom(sr, dsp::ZoomBand{50.0f, 70.0f, 256});
+
+    CHECK(zoom.binHz() < 0.2f);
+    CHECK(zoom.startHz() >= 50.0f);
+
+    feed(zoom, tones(sr, 8.0, {60.3}));
+    REQUIRE(zoom.filled() == 256);
+    const auto bins = zoom.compute();
+    REQUIRE(!bins.empty());
+    CHECK(zoom.startHz() + zoom.binHz() * float(bins.size() - 1) <= 70.0f);
+    CHECK(std::abs(peakHz(zoom, bins) - 60.3f) <= zoom.binHz());
+}
+
+TEST_CASE("Zoom FFT separates tones one hertz apart") {
+    const int sr = 48000;
+    dsp::ZoomAnalyzer zoom(sr, dsp::ZoomBand{55.0f, 65.0f, 256});
+    feed(zoom, tones(sr, 14.0, {59.5, 60.5}));
+    const auto bins = zoom.compute();
+
+    // Two local maxima near the tones with a clear dip between them.
+    auto binOf = [&](float hz) { return std::size_t(std::lround((hz - zoom.startHz()) / zoom.binHz())); };
+    const float a = bins[binOf(59.5f)];
+    const float b = bins[binOf(60.5f)];
+    const float mid = bins[binOf(60.0f)];
+    CHECK(mid < 0.1f * a);
+    CHECK(mid < 0.1f * b);
+}
+
+TEST_CASE("Zoom FFT rejects tones outside the band") {
+    const int sr = 44100;
+    dsp::ZoomAnalyzer inBand(sr, dsp::ZoomBand{50.0f, 70.0f, 256});
+    dsp::ZoomAnalyzer outOfBand(sr, dsp::ZoomBand{50.0f, 70.0f, 256});
+
+    feed(inBand, tones(sr, 8.0, {60.0}));
+    // 100 Hz is one decimated sample rate above the centre and would alias
+    // onto it without the decimation filter.
+    feed(outOfBand, tones(sr, 8.0, {100.0, 1000.0}));
+
+    const auto in = inBand.compute();
+    const auto out = outOfBand.compute();
+    const float inPeak = *std::max_element(in.begin(), in.end());
+    const float outPeak = *std::max_element(out.begin(), out.end());
+    CHECK(outPeak < 1e-3f * inPeak);
+}
+
+TEST_CASE("Zoom transform uses the captured window even if samples arrive meanwhile") {
+    const int sr = 44100;
+    dsp::ZoomAnalyzer a(sr, dsp::ZoomBand{50.0f, 70.0f, 128});
+    dsp::ZoomAnalyzer b(sr, dsp::ZoomBand{50.0f, 70.0f, 128});
+    const auto s = tones(sr, 4.0, {61.0});
+    feed(a, s);
+    feed(b, s);
+
+    const std::vector<float> expected = a.compute();
+    b.capture();
+    feed(b, tones(sr, 1.0, {52.0}));
+    CHECK(b.transform() == expected);
+}
+
+TEST_CASE("Zoom bands that would need unbounded buffers are invalid") {
+    const int sr = 44100;
+    CHECK(dsp::ZoomAnalyzer::valid(sr, dsp::ZoomBand{50.0f, 70.0f, 256}));
+    CHECK_FALSE(dsp::ZoomAnalyzer::valid(sr, dsp::ZoomBand{50.0f, 50.001f, 256}));
+    CHECK_FALSE(dsp::ZoomAnalyzer::valid(sr, dsp::ZoomBand{50.0f, 70.0f, 300}));
+    CHECK_FALSE(dsp::ZoomAnalyzer::valid(sr, dsp::ZoomBand{50.0f, 70.0f, 1 << 20}));
+    CHECK_FALSE(dsp::ZoomAnalyzer::valid(sr, dsp::ZoomBand{50.0f, std::nanf(""), 256}));
+    CHECK(dsp::ZoomAnalyzer::valid(sr, dsp::ZoomBand{50.0f, 70.0f, dsp::ZoomAnalyzer::kMaxFftSize}));
+
+    // The narrowest accepted band still has a bounded filter.
+    const float narrowest = 60.0f + float(sr) / (2.0f * dsp::ZoomAnalyzer::kMaxDecimation) + 0.01f;
+    REQUIRE(dsp::ZoomAnalyzer::valid(sr, dsp::ZoomBand{60.0f, narrowest, 256}));
+    CHECK(dsp::ZoomAnalyzer(sr, dsp::ZoomBand{60.0f, narrowest, 256}).decimation() <= dsp::ZoomAnalyzer::kMaxDecimation);
+}
+
+TEST_CASE("AudioEngine publishes a zoom spectrum that can be changed at runtime") {
+    AudioEngine engine(44100, 1024, 64, "");
+    CHECK_FALSE(engine.setZoomBand(70.0f, 50.0f));
+    CHECK_FALSE(engine.setZoomBand(20000.0f, 23000.0f));
+    CHECK_FALSE(engine.setZoomBand(50.0f, 50.001f));
+
+    engine.startHosted();
+    engine.runHop();
+    CHECK(engine.getZoomSpectrum().bins.empty());
+
+    REQUIRE(engine.setZoomBand(50.0f, 70.0f, 128));
+    const auto s = tones(44100, 4.0, {62.0});
+    for (std::size_t pos = 0; pos < s.size(); pos += 2205) {
+        engine.pushSamples(s.data() + pos, std::min<std::size_t>(2205, s.size() - pos));
+        engine.runHop();
+    }
+    auto zoom = engine.getZoomSpectrum();
+    REQUIRE(!zoom.bins.empty());
+    CHECK(zoom.lowHz == 50.0f);
+    CHECK(zoom.highHz == 70.0f);
+    const auto peak = std::max_element(zoom.bins.begin(), zoom.bins.end()) - zoom.bins.begin();
+    CHECK(std::abs(zoom.startHz + zoom.binHz * float(peak) - 62.0f) <= zoom.binHz);
+    CHECK(engine.getLogBins().size() == 64);
+
+    REQUIRE(engine.setZoomBand(990.0f, 1010.0f, 64));
+    engine.runHop();
+    CHECK(engine.getZoomSpectrum().lowHz == 990.0f);
+
+    engine.clearZoomBand();
+    engine.runHop();
+    CHECK(engine.getZoomSpectrum().bins.empty());
+    engine.stop();
+}
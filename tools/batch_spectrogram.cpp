@@ -0,0 +1,37 @@
+// Offline spectrogram of a FLAC recording on all cores.
+//
+// Usage: batch_spectrogram <input.flac> <output.f32> [fftSize] [logBins] [hopMs] [workers]
+//
+// Writes raw float32 frames (logBins per frame) to output.f32 and the
+// metadata message with the bin centers to output.f32.json.
+
+#include "BatchSpectrogram.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <input.flac> <output.f32> [fftSize] [logBins] [hopMs] [workers]\n";
+        return 2;
+    }
+
+    BatchSpectrogram::Options options;
+    if (argc > 3) options.fftSize = std::atoi(argv[3]);
+    if (argc > 4) options.logBins = std::atoi(argv[4]);
+    if (argc > 5) options.hopMs = std::atoi(argv[5]);
+    if (argc > 6) options.workers = std::atoi(argv[6]);
+
+    BatchSpectrogram::Result result;
+    std::string error;
+    if (!BatchSpectrogram::processFlac(argv[1], argv[2], options, &result, &error)) {
+        std::cerr << "batch_spectrogram: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << result.frames << " frames x " << result.logBins << " bins, "
+              << result.audioSeconds << " s of audio in " << result.wallSeconds << " s ("
+              << result.audioSecondsPerWallSecond() << " audio-s/wall-s)\n";
+    return 0;
+}
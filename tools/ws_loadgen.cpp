@@ -0,0 +1,572 @@
+// WebSocket fan-out load generator: opens many loopback connections to an
+// EngineHost endpoint and reports per-frame delivery latency (from the "ts"
+// field of each frame) and receive gaps as percentiles.
+//
+// - Clients send masked text frames like a browser would; a server that
+//   rejects them drops the connection, which counts as a failure, as does a
+//   handshake reply whose Sec-WebSocket-Accept does not match the key sent
+// - A fraction of clients can be slow readers (throttled reads), and clients
+//   can be closed and reopened at a fixed churn rate
+// - Without --port, an in-process EngineHost with synthetic sine sources is
+//   started on port 18787 and measured
+//
+// Usage: ws_loadgen [--clients N] [--seconds S] [--port P] [--sources K]
+//                   [--hop-ms H] [--slow FRACTION] [--slow-bps BYTES]
+//                   [--churn PER_SECOND] [--threads T] [--max-p99-ms MS]
+//
+// Exits non-zero if clients fail to connect, are dropped by the server, or
+// the p99 latency of normal (not slow) clients exceeds --max-p99-ms.
+
+#include "AudioEngine.hpp"
+#include "EngineHost.hpp"
+#include "WebSocketServer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Args {
+    int clients = 1000;
+    int seconds = 10;
+    int port = -1;
+    int sources = 1;
+    int hopMs = 50;
+    double slow = 0.0;
+    int slowBytesPerSec = 4096;
+    double churnPerSec = 0.0;
+    int threads = 2;
+    double maxP99Ms = 0.0;
+};
+
+std::int64_t wallMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+float percentile(std::vector<float> v, double p) {
+    if (v.empty()) return 0.0f;
+    std::sort(v.begin(), v.end());
+    const std::size_t idx = std::min(v.size() - 1, static_cast<std::size_t>(p * (v.size() - 1) + 0.5));
+    return v[idx];
+}
+
+std::string base64(const std::uint8_t* data, std::size_t len) {
+    static constexpr char kTbl[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (std::size_t i = 0; i < len; i += 3) {
+        std::uint32_t v = std::uint32_t(data[i]) << 16;
+        if (i + 1 < len) v |= std::uint32_t(data[i + 1]) << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out.push_back(kTbl[(v >> 18) & 0x3F]);
+        out.push_back(kTbl[(v >> 12) & 0x3F]);
+        out.push_back(i + 1 < len ? kTbl[(v >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < len ? kTbl[v & 0x3F] : '=');
+    }
+    return out;
+}
+
+// Integer value following "key": in a frame, or -1.
+std::int64_t numberField(const std::string& text, const char* key) {
+    const std::size_t pos = text.find(key);
+    if (pos == std::string::npos) return -1;
+    return std::strtoll(text.c_str() + pos + std::strlen(key), nullptr, 10);
+}
+
+// Sec-WebSocket-Accept value of a handshake reply head ("" if absent).
+std::string acceptField(const std::string& head) {
+    std::string lower = head;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    const char* name = "\r\nsec-websocket-accept:";
+    std::size_t begin = lower.find(name);
+    if (begin == std::string::npos) return {};
+    begin += std::strlen(name);
+    std::size_t end = head.find("\r\n", begin);
+    if (end == std::string::npos) end = head.size();
+    while (begin < end && (head[begin] == ' ' || head[begin] == '\t')) ++begin;
+    while (end > begin && (head[end - 1] == ' ' || head[end - 1] == '\t')) --end;
+    return head.substr(begin, end - begin);
+}
+
+// Source id of a frame ("" if absent).
+std::string sourceField(const std::string& text) {
+    const std::size_t pos = text.find("\"source\":\"");
+    if (pos == std::string::npos) return {};
+    const std::size_t begin = pos + 10;
+    const std::size_t end = text.find('"', begin);
+    return end == std::string::npos ? std::string{} : text.substr(begin, end - begin);
+}
+
+struct Stats {
+    std::vector<float> latencyMs;
+    std::vector<float> gapMs;
+    std::uint64_t frames = 0;
+    std::uint64_t missed = 0;
+    std::uint64_t bytes = 0;
+};
+
+struct Connection {
+    enum class State { Idle, Connecting, Handshake, Open };
+
+    int fd = -1;
+    State state = State::Idle;
+    bool slow = false;
+    bool reconnecting = false; // closed by churn, new handshake not done yet
+    std::string key;
+    std::string in;
+    std::map<std::string, std::int64_t> lastSeq;
+    std::int64_t lastFrameUs = 0;
+    Clock::time_point nextSend{};
+    Stats stats;
+};
+
+struct Totals {
+    int connected = 0;
+    int failed = 0;
+    int dropped = 0;
+    int churned = 0;
+    int reconnecting = 0; // churned connections still opening at the end
+};
+
+// One epoll loop driving a share of the connections.
+class ClientThread {
+public:
+    ClientThread(const Args& args, int port, int count, int firstId)
+        : m_args(args), m_port(port), m_rng(static_cast<unsigned>(firstId * 7919 + 1)) {
+        m_conns.resize(static_cast<std::size_t>(count));
+        const int slowCount = static_cast<int>(std::lround(args.slow * count));
+        for (int i = 0; i < slowCount; ++i) m_conns[static_cast<std::size_t>(i)].slow = true;
+        m_epoll = ::epoll_create1(0);
+    }
+
+    ~ClientThread() {
+        for (auto& c : m_conns)
+            if (c.fd >= 0) ::close(c.fd);
+        if (m_epoll >= 0) ::close(m_epoll);
+    }
+
+    void run(Clock::time_point until) {
+        // Connections are opened over the first second so the handshakes do
+        // not all hit the accept queue at once.
+        const auto start = Clock::now();
+        std::size_t opened = 0;
+        auto nextSlowRead = start;
+        auto nextChurn = start + std::chrono::seconds(1);
+        const double churnPerThread = m_args.churnPerSec / std::max(1, m_args.threads);
+
+        std::vector<epoll_event> events(256);
+        while (Clock::now() < until) {
+            const auto now = Clock::now();
+            const double rampFraction = std::min(1.0, std::chrono::duration<double>(now - start).count());
+            while (opened < static_cast<std::size_t>(rampFraction * m_conns.size())) open(m_conns[opened++]);
+
+            const int n = ::epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), 10);
+            for (int i = 0; i < n; ++i) {
+                const epoll_event& ev = events[static_cast<std::size_t>(i)];
+                service(m_conns[ev.data.u64], ev.events);
+            }
+
+            if (now >= nextSlowRead) {
+                // Slow readers drain a fixed budget ten times a second.
+                const std::size_t budget = static_cast<std::size_t>(std::max(1, m_args.slowBytesPerSec / 10));
+                for (auto& c : m_conns)
+                    if (c.slow && c.state == Connection::State::Open) readSome(c, budget);
+                nextSlowRead += std::chrono::milliseconds(100);
+            }
+
+            for (auto& c : m_conns)
+                if (c.state == Connection::State::Open && now >= c.nextSend) sendClientMessage(c, now);
+
+            if (churnPerThread > 0.0 && now >= nextChurn) {
+                std::uniform_int_distribution<std::size_t> pick(0, m_conns.size() - 1);
+                Connection& c = m_conns[pick(m_rng)];
+                if (c.state == Connection::State::Open) {
+                    sendFrame(c, 0x8, "");
+                    reset(c);
+                    ++m_totals.churned;
+                    c.reconnecting = true;
+                    open(c);
+                }
+                nextChurn += std::chrono::microseconds(static_cast<std::int64_t>(1e6 / churnPerThread));
+            }
+        }
+
+        for (auto& c : m_conns) {
+            if (c.state == Connection::State::Open) ++m_totals.connected;
+            else if (c.reconnecting && c.fd >= 0) ++m_totals.reconnecting;
+        }
+    }
+
+    const std::vector<Connection>& connections() const { return m_conns; }
+    const Totals& totals() const { return m_totals; }
+
+private:
+    void open(Connection& c) {
+        c.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (c.fd < 0) {
+            ++m_totals.failed;
+            return;
+        }
+        if (c.slow) {
+            // Small receive buffer so a slow reader pushes back on the server quickly.
+            const int rcv = 16 * 1024;
+            (void)::setsockopt(c.fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(m_port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(c.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 && errno != EINPROGRESS) {
+            ::close(c.fd);
+            c.fd = -1;
+            ++m_totals.failed;
+            return;
+        }
+
+        c.state = Connection::State::Connecting;
+        epoll_event ev{};
+        ev.events = EPOLLOUT;
+        ev.data.u64 = static_cast<std::uint64_t>(&c - m_conns.data());
+        ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+
+    void reset(Connection& c) {
+        if (c.fd >= 0) ::close(c.fd); // also removes it from the epoll set
+        c.fd = -1;
+        c.state = Connection::State::Idle;
+        c.in.clear();
+        c.lastSeq.clear();
+        c.lastFrameUs = 0;
+    }
+
+    void service(Connection& c, std::uint32_t events) {
+        if (c.state == Connection::State::Connecting) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            ::getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+                reset(c);
+                ++m_totals.failed;
+                return;
+            }
+
+            std::uint8_t nonce[16];
+            for (auto& b : nonce) b = static_cast<std::uint8_t>(m_rng());
+            c.key = base64(nonce, sizeof(nonce));
+            const std::string req =
+                "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                "Sec-WebSocket-Key: " + c.key + "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+            (void)::send(c.fd, req.data(), req.size(), MSG_NOSIGNAL);
+
+            c.state = Connection::State::Handshake;
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.u64 = static_cast<std::uint64_t>(&c - m_conns.data());
+            ::epoll_ctl(m_epoll, EPOLL_CTL_MOD, c.fd, &ev);
+            return;
+        }
+
+        readSome(c, 64 * 1024);
+    }
+
+    void readSome(Connection& c, std::size_t budget) {
+        char buf[16 * 1024];
+        while (budget > 0 && c.fd >= 0) {
+            const ssize_t n = ::recv(c.fd, buf, std::min(sizeof(buf), budget), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+            if (n <= 0) {
+                // The server hung up on us.
+                if (c.state == Connection::State::Open) ++m_totals.dropped;
+                else ++m_totals.failed;
+                reset(c);
+                return;
+            }
+            budget -= static_cast<std::size_t>(n);
+            c.stats.bytes += static_cast<std::uint64_t>(n);
+            c.in.append(buf, static_cast<std::size_t>(n));
+            parse(c);
+        }
+    }
+
+    void parse(Connection& c) {
+        if (c.state == Connection::State::Handshake) {
+            const std::size_t end = c.in.find("\r\n\r\n");
+            if (end == std::string::npos) return;
+            if (c.in.compare(0, 12, "HTTP/1.1 101") != 0 ||
+                acceptField(c.in.substr(0, end)) != WebSocketServer::makeAcceptKey(c.key)) {
+                reset(c);
+                ++m_totals.failed;
+                return;
+            }
+            c.in.erase(0, end + 4);
+            c.state = Connection::State::Open;
+            c.reconnecting = false;
+            c.nextSend = Clock::now() + std::chrono::seconds(1);
+            if (c.slow) {
+                // Slow readers are only read on the throttle timer.
+                epoll_event ev{};
+                ev.events = 0;
+                ev.data.u64 = static_cast<std::uint64_t>(&c - m_conns.data());
+                ::epoll_ctl(m_epoll, EPOLL_CTL_MOD, c.fd, &ev);
+            }
+        }
+
+        std::size_t pos = 0;
+        for (;;) {
+            if (c.in.size() - pos < 2) break;
+            const auto b1 = static_cast<std::uint8_t>(c.in[pos + 1]);
+            std::size_t header = 2;
+            std::uint64_t len = b1 & 0x7F;
+            if (len == 126) {
+                if (c.in.size() - pos < 4) break;
+                len = (std::uint64_t(std::uint8_t(c.in[pos + 2])) << 8) | std::uint8_t(c.in[pos + 3]);
+                header = 4;
+            } else if (len == 127) {
+                if (c.in.size() - pos < 10) break;
+                len = 0;
+                for (std::size_t k = 0; k < 8; ++k) len = (len << 8) | std::uint8_t(c.in[pos + 2 + k]);
+                header = 10;
+            }
+            if (c.in.size() - pos < header + len) break;
+
+            const int opcode = c.in[pos] & 0x0F;
+            if (opcode == 0x1) onText(c, c.in.substr(pos + header, static_cast<std::size_t>(len)));
+            pos += header + static_cast<std::size_t>(len);
+        }
+        c.in.erase(0, pos);
+    }
+
+    void onText(Connection& c, const std::string& text) {
+        const std::int64_t now = wallMicros();
+        const std::int64_t ts = numberField(text, "\"ts\":");
+        const std::int64_t seq = numberField(text, "\"seq\":");
+        if (ts < 0 || seq < 0) return; // metadata
+
+        c.stats.frames++;
+        c.stats.latencyMs.push_back(static_cast<float>(now - ts) / 1000.0f);
+        if (c.lastFrameUs > 0) c.stats.gapMs.push_back(static_cast<float>(now - c.lastFrameUs) / 1000.0f);
+        c.lastFrameUs = now;
+
+        const auto inserted = c.lastSeq.emplace(sourceField(text), seq);
+        std::int64_t& last = inserted.first->second;
+        if (!inserted.second && seq > last + 1) c.stats.missed += static_cast<std::uint64_t>(seq - last - 1);
+        last = seq;
+    }
+
+    void sendClientMessage(Connection& c, Clock::time_point now) {
+        sendFrame(c, 0x1, "{\"type\":\"loadgen\"}");
+        c.nextSend = now + std::chrono::seconds(1);
+    }
+
+    // Client-to-server frames are masked with a fresh key (RFC 6455 5.3).
+    void sendFrame(Connection& c, std::uint8_t opcode, const std::string& payload) {
+        std::uint8_t mask[4];
+        for (auto& b : mask) b = static_cast<std::uint8_t>(m_rng());
+
+        std::string frame;
+        frame.push_back(static_cast<char>(0x80 | opcode));
+        const std::uint64_t len = payload.size();
+        if (len < 126) {
+            frame.push_back(static_cast<char>(0x80 | len));
+        } else if (len <= 0xFFFF) {
+            frame.push_back(static_cast<char>(0x80 | 126));
+            frame.push_back(static_cast<char>(len >> 8));
+            frame.push_back(static_cast<char>(len & 0xFF));
+        } else {
+            frame.push_back(static_cast<char>(0x80 | 127));
+            for (int shift = 56; shift >= 0; shift -= 8) frame.push_back(static_cast<char>((len >> shift) & 0xFF));
+        }
+        frame.append(reinterpret_cast<const char*>(mask), 4);
+        for (std::size_t i = 0; i < payload.size(); ++i) frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+        (void)::send(c.fd, frame.data(), frame.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+
+    const Args& m_args;
+    const int m_port;
+    std::mt19937 m_rng;
+    int m_epoll = -1;
+    std::vector<Connection> m_conns;
+    Totals m_totals;
+};
+
+void raiseFdLimit(int needed) {
+    rlimit lim{};
+    if (::getrlimit(RLIMIT_NOFILE, &lim) != 0) return;
+    if (lim.rlim_cur >= static_cast<rlim_t>(needed)) return;
+    lim.rlim_cur = std::min<rlim_t>(lim.rlim_max, static_cast<rlim_t>(needed));
+    (void)::setrlimit(RLIMIT_NOFILE, &lim);
+    if (lim.rlim_cur < static_cast<rlim_t>(needed))
+        std::cerr << "warning: file descriptor limit " << lim.rlim_cur << " is below " << needed << "\n";
+}
+
+void reportRow(const char* label, const std::vector<float>& ms) {
+    std::cout << std::left << std::setw(16) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ms.size()
+              << std::setw(10) << percentile(ms, 0.50)
+              << std::setw(10) << percentile(ms, 0.90)
+              << std::setw(10) << percentile(ms, 0.99)
+              << std::setw(10) << percentile(ms, 0.999)
+              << std::setw(10) << (ms.empty() ? 0.0f : *std::max_element(ms.begin(), ms.end()))
+              << "\n";
+}
+
+bool parseArgs(int argc, char** argv, Args& args) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string k = argv[i];
+        const char* v = argv[i + 1];
+        if (k == "--clients") args.clients = std::max(1, std::atoi(v));
+        else if (k == "--seconds") args.seconds = std::max(1, std::atoi(v));
+        else if (k == "--port") args.port = std::atoi(v);
+        else if (k == "--sources") args.sources = std::max(1, std::atoi(v));
+        else if (k == "--hop-ms") args.hopMs = std::max(1, std::atoi(v));
+        else if (k == "--slow") args.slow = std::clamp(std::atof(v), 0.0, 1.0);
+        else if (k == "--slow-bps") args.slowBytesPerSec = std::max(1, std::atoi(v));
+        else if (k == "--churn") args.churnPerSec = std::max(0.0, std::atof(v));
+        else if (k == "--threads") args.threads = std::max(1, std::atoi(v));
+        else if (k == "--max-p99-ms") args.maxP99Ms = std::max(0.0, std::atof(v));
+        else return false;
+    }
+    return argc % 2 == 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args;
+    if (!parseArgs(argc, argv, args)) {
+        std::cerr << "usage: " << argv[0] << " [--clients N] [--seconds S] [--port P] [--sources K] [--hop-ms H]"
+                  << " [--slow FRACTION] [--slow-bps BYTES] [--churn PER_SECOND] [--threads T] [--max-p99-ms MS]\n";
+        return 2;
+    }
+    raiseFdLimit(args.clients * 2 + 64);
+
+    // Synthetic sources: sines pushed in real time into hosted engines.
+    std::unique_ptr<EngineHost> host;
+    std::atomic<bool> stopFeed{false};
+    std::thread feeder;
+    int port = args.port;
+    if (port < 0) {
+        port = 18787;
+        host = std::make_unique<EngineHost>();
+        std::vector<AudioEngine*> engines;
+        for (int i = 0; i < args.sources; ++i)
+            engines.push_back(&host->addEngine("synth-" + std::to_string(i),
+                                               std::make_unique<AudioEngine>(48000, 1024, 64), args.hopMs));
+        host->start(port);
+
+        feeder = std::thread([engines, &stopFeed] {
+            std::vector<float> block(256);
+            std::size_t n = 0;
+            auto next = Clock::now();
+            while (!stopFeed.load()) {
+                for (auto& s : block) s = std::sin(0.02f * float(n++));
+                for (auto* e : engines) e->pushSamples(block.data(), block.size());
+                next += std::chrono::microseconds(256 * 1000000 / 48000);
+                std::this_thread::sleep_until(next);
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    std::cout << args.clients << " clients (" << args.slow * 100.0 << "% slow at " << args.slowBytesPerSec
+              << " B/s), churn " << args.churnPerSec << "/s, " << args.seconds << "s against port " << port << "\n";
+
+    std::vector<std::unique_ptr<ClientThread>> threads;
+    const int perThread = (args.clients + args.threads - 1) / args.threads;
+    for (int t = 0, first = 0; t < args.threads && first < args.clients; ++t, first += perThread)
+        threads.push_back(std::make_unique<ClientThread>(args, port, std::min(perThread, args.clients - first), first));
+
+    const auto until = Clock::now() + std::chrono::seconds(args.seconds);
+    std::vector<std::thread> runners;
+    for (auto& t : threads) runners.emplace_back([&t, until] { t->run(until); });
+    for (auto& r : runners) r.join();
+
+    stopFeed = true;
+    if (feeder.joinable()) feeder.join();
+
+    Totals totals;
+    Stats normal;
+    Stats slow;
+    std::vector<float> clientP99;
+    for (const auto& t : threads) {
+        totals.connected += t->totals().connected;
+        totals.failed += t->totals().failed;
+        totals.dropped += t->totals().dropped;
+        totals.churned += t->totals().churned;
+        totals.reconnecting += t->totals().reconnecting;
+        for (const auto& c : t->connections()) {
+            Stats& into = c.slow ? slow : normal;
+            into.latencyMs.insert(into.latencyMs.end(), c.stats.latencyMs.begin(), c.stats.latencyMs.end());
+            into.gapMs.insert(into.gapMs.end(), c.stats.gapMs.begin(), c.stats.gapMs.end());
+            into.frames += c.stats.frames;
+            into.missed += c.stats.missed;
+            into.bytes += c.stats.bytes;
+            if (!c.slow && !c.stats.latencyMs.empty()) clientP99.push_back(percentile(c.stats.latencyMs, 0.99));
+        }
+    }
+
+    std::cout << "connected " << totals.connected << ", failed " << totals.failed << ", dropped by server "
+              << totals.dropped << ", churned " << totals.churned << " (" << totals.reconnecting
+              << " still reconnecting at the end)\n";
+    std::cout << "frames " << normal.frames + slow.frames << " (" << normal.missed + slow.missed << " missed), "
+              << (normal.bytes + slow.bytes) / (1024.0 * 1024.0) / args.seconds << " MiB/s received\n";
+    std::cout << "(ms)               count       p50       p90       p99     p99.9       max\n";
+    reportRow("latency", normal.latencyMs);
+    reportRow("receive gap", normal.gapMs);
+    if (!slow.latencyMs.empty()) {
+        reportRow("slow latency", slow.latencyMs);
+        reportRow("slow gap", slow.gapMs);
+    }
+    reportRow("client p99", clientP99);
+
+    if (host) {
+        for (const auto& s : host->stats())
+            std::cout << s.sourceId << ": " << s.hops << " hops, " << s.lateHops << " late, " << s.skippedHops
+                      << " skipped\n";
+        host->stop();
+    }
+
+    bool ok = true;
+    // A churned connection caught mid-handshake by the end of the run is not
+    // a failure to connect.
+    if (totals.failed > 0 || totals.connected + totals.reconnecting < args.clients) {
+        std::cout << "FAIL: not all clients connected\n";
+        ok = false;
+    }
+    if (totals.dropped > 0) {
+        std::cout << "FAIL: server dropped clients\n";
+        ok = false;
+    }
+    const float p99 = percentile(normal.latencyMs, 0.99);
+    if (args.maxP99Ms > 0.0 && (normal.latencyMs.empty() || p99 > args.maxP99Ms)) {
+        std::cout << "FAIL: p99 latency " << p99 << " ms exceeds " << args.maxP99Ms << " ms\n";
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}